@@ -121,17 +121,17 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
         return 1;
     }
 
-    auto query = reinterpret_cast<LB_QueryPlatformV1Fn>(
-        GetProcAddress(dll, "LB_QueryPlatformV1"));
+    auto query = reinterpret_cast<LB_QueryPlatformFn>(
+        GetProcAddress(dll, "LB_QueryPlatform"));
     if (!query) {
-        MessageBoxA(nullptr, "LB_QueryPlatformV1 missing", "Error", MB_ICONERROR);
+        MessageBoxA(nullptr, "LB_QueryPlatform missing", "Error", MB_ICONERROR);
         return 2;
     }
 
     LB_PlatformV1 plat{};
-    LB_ErrorCode query_rc = query(&plat);
+    LB_ErrorCode query_rc = query(&plat, sizeof(plat));
     if (query_rc != LB_Error_Ok) {
-        MessageBoxA(nullptr, "LB_QueryPlatformV1 failed", "Error", MB_ICONERROR);
+        MessageBoxA(nullptr, "LB_QueryPlatform failed", "Error", MB_ICONERROR);
         return 3;
     }
     if (plat.abi_version != LB_PLATFORM_ABI_VERSION) {
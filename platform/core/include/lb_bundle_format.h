@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// On-disk layout of a packed resource bundle (little-endian), shared by the
+// lbw_bundle_pack tool and the platform's bundle_* runtime API.
+//
+//   LB_BundleHeader
+//   uint32_t seeds[bucket_count]          perfect-hash displacement per bucket
+//   zero padding                          up to LB_BUNDLE_TABLE_ALIGNMENT (odd bucket counts)
+//   LB_BundleEntry entries[entry_count]   slot order given by the perfect hash
+//   name block                            UTF-8 resource paths, '/' separated, not terminated
+//   data block                            file contents, each aligned to LB_BUNDLE_DATA_ALIGNMENT
+//
+// Lookup: bucket = hash(path, 0) % bucket_count, slot = hash(path, seeds[bucket]) % entry_count,
+// then compare the stored name to reject paths that are not in the bundle.
+
+#define LB_BUNDLE_MAGIC 0x4252424Cu // "LBRB"
+#define LB_BUNDLE_VERSION 1u
+#define LB_BUNDLE_DATA_ALIGNMENT 16u
+// entries_offset is a multiple of this (alignof(LB_BundleEntry)); readers reject other offsets.
+#define LB_BUNDLE_TABLE_ALIGNMENT 8u
+
+typedef struct LB_BundleHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t bucket_count;
+    uint64_t seeds_offset;
+    uint64_t entries_offset;
+    uint64_t names_offset;
+    uint64_t file_size;
+} LB_BundleHeader;
+
+typedef struct LB_BundleEntry {
+    uint64_t data_offset; // from the start of the bundle
+    uint64_t data_size;
+    uint32_t name_offset; // from names_offset
+    uint32_t name_length;
+} LB_BundleEntry;
+
+// FNV-1a over the path, seeded and finalized with a splitmix64 mix.
+static inline uint64_t lb_bundle_hash(const char *path, size_t length, uint32_t seed) {
+    uint64_t h = 0xcbf29ce484222325ull ^ ((uint64_t)seed * 0x9e3779b97f4a7c15ull);
+    for (size_t i = 0; i < length; ++i) {
+        h ^= (uint8_t)path[i];
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+#ifdef __cplusplus
+}
+#endif
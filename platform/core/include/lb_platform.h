@@ -7,8 +7,10 @@
 extern "C" {
 #endif
 
-// ABI version exported by the platform layer.
-#define LB_PLATFORM_ABI_VERSION 1u
+// ABI version exported by the platform layer. Version 2 appended entries to LB_PlatformV1 and
+// fields to LB_NetRequestDesc and LB_NetResponse; hosts built against version 1 keep working
+// through LB_QueryPlatformV1, which fills only the version 1 table.
+#define LB_PLATFORM_ABI_VERSION 2u
 
 // Error codes returned by platform functions.
 typedef enum LB_ErrorCode {
@@ -16,7 +18,9 @@ typedef enum LB_ErrorCode {
     LB_Error_Unknown = 1,
     LB_Error_BadArgument = 2,
     LB_Error_NotSupported = 3,
-    LB_Error_OutOfMemory = 4
+    LB_Error_OutOfMemory = 4,
+    LB_Error_Busy = 5,
+    LB_Error_NotFound = 6
 } LB_ErrorCode;
 
 typedef void (*lb_timer_cb)(void *);
@@ -27,6 +31,21 @@ typedef struct lb_window lb_window;
 struct lb_net_request;
 typedef struct lb_net_request lb_net_request;
 
+struct lb_net_download;
+typedef struct lb_net_download lb_net_download;
+
+struct lb_fs_request;
+typedef struct lb_fs_request lb_fs_request;
+
+struct lb_dir_iterator;
+typedef struct lb_dir_iterator lb_dir_iterator;
+
+struct lb_fs_watch;
+typedef struct lb_fs_watch lb_fs_watch;
+
+struct lb_bundle;
+typedef struct lb_bundle lb_bundle;
+
 typedef enum LB_ModifierFlags {
     LB_Mod_None   = 0,
     LB_Mod_Shift  = 1u << 0,
@@ -147,11 +166,125 @@ typedef struct LB_FileStat {
     uint8_t reserved[3];
 } LB_FileStat;
 
+// Access pattern hints for fs_map_file (bitmask).
+typedef enum LB_MapHint {
+    LB_MapHint_None       = 0,
+    LB_MapHint_Sequential = 1u << 0,
+    LB_MapHint_Random     = 1u << 1,
+    LB_MapHint_WillNeed   = 1u << 2  // page the whole view in ahead of first access
+} LB_MapHint;
+
+// Durability options for fs_write_file_ex / fs_write_async_ex (bitmask).
+typedef enum LB_WriteFlags {
+    LB_WriteFlag_None        = 0,       // truncate and write in place (fs_write_entire_file)
+    LB_WriteFlag_Atomic      = 1u << 0, // write a temporary file next to the target, then replace it
+    LB_WriteFlag_Flush       = 1u << 1, // flush data to stable storage before reporting success
+    LB_WriteFlag_GroupCommit = 1u << 2  // async only: flush together with other queued writes; implies Flush
+} LB_WriteFlags;
+
+// Read-only view of a file mapped into the address space. Release with fs_unmap_file.
+typedef struct LB_MappedFile {
+    const uint8_t *data; // nullptr for empty files
+    size_t size;
+} LB_MappedFile;
+
+// Read-only file contents shared with the platform file cache. Release with fs_cache_release.
+typedef struct LB_CachedFile {
+    const uint8_t *data;
+    size_t size;
+    void *ref; // opaque reference held on the cached contents
+} LB_CachedFile;
+
+typedef struct LB_FileCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations; // entries dropped because size or last-write time changed
+    uint64_t evictions;     // entries dropped to stay within capacity
+    uint64_t bytes_cached;
+    uint64_t capacity;
+} LB_FileCacheStats;
+
+// Zero-copy view of one resource inside an open bundle; valid until bundle_close.
+typedef struct LB_BundleSlice {
+    const uint8_t *data;
+    size_t size;
+} LB_BundleSlice;
+
 typedef struct LB_DirectoryListing {
     LB_Buffer entries; // double-null UTF-8 list
     size_t count;
 } LB_DirectoryListing;
 
+// Receives one chunk of a streamed file read. `data` is only valid during the call; the next
+// chunk is not delivered until the callback returns. Return nonzero to stop reading.
+typedef int (*LB_FileChunkCallback)(const uint8_t *data, size_t size, uint64_t offset, void *ctx);
+
+// Reports that one fs_prefetch path (by index into the submitted array) is resident, or failed.
+typedef void (*LB_FsPrefetchCallback)(size_t index, LB_ErrorCode error, void *ctx);
+
+// Directory entry with metadata captured during enumeration.
+typedef struct LB_DirectoryEntry {
+    size_t name_offset; // byte offset of the null-terminated UTF-8 name from the start of the owning buffer
+    size_t name_length;
+    uint64_t size;
+    uint64_t modified_timestamp; // FILETIME (100-ns since 1601-01-01)
+    uint32_t attributes;
+    uint8_t is_directory;
+    uint8_t reserved[3];
+} LB_DirectoryEntry;
+
+typedef struct LB_DirectoryListingEx {
+    LB_Buffer buffer; // single allocation: entries array followed by the name block; release with buffer_free
+    const LB_DirectoryEntry *entries; // points into buffer
+    size_t count;
+} LB_DirectoryListingEx;
+
+typedef enum LB_WalkFlags {
+    LB_Walk_None                = 0,
+    LB_Walk_SkipHidden          = 1u << 0,
+    LB_Walk_SkipDirectories     = 1u << 1, // descend into directories but do not report them
+    LB_Walk_FollowReparsePoints = 1u << 2  // descend through junctions/symlinks (may revisit paths)
+} LB_WalkFlags;
+
+typedef struct LB_WalkOptions {
+    uint32_t flags;       // LB_WalkFlags
+    uint32_t max_depth;   // 0 = unlimited, 1 = only the root's direct children
+    uint32_t max_threads; // 0 = one worker per core (capped by the platform)
+    // Optional; called on worker threads with the root-relative path. Return 0 to drop the
+    // entry (directories that are dropped are not descended into).
+    int (*filter)(const char *relative_path_utf8, const LB_FileStat *stat, void *ctx);
+    void *filter_ctx;
+} LB_WalkOptions;
+
+// Receives walk results in LB_DirectoryListingEx layout; names are root-relative paths and
+// the batch is only valid during the call. Return nonzero to stop the walk.
+typedef int (*LB_WalkBatchCallback)(const LB_DirectoryListingEx *batch, void *ctx);
+
+typedef enum LB_FsChangeFlags {
+    LB_FsChange_Added    = 1u << 0,
+    LB_FsChange_Removed  = 1u << 1,
+    LB_FsChange_Modified = 1u << 2,
+    LB_FsChange_Renamed  = 1u << 3,
+    LB_FsChange_Overflow = 1u << 4, // events were dropped; path is empty, rescan the watched tree
+    LB_FsChange_Error    = 1u << 5  // the watch failed (e.g. its directory went away) and stopped; path is empty
+} LB_FsChangeFlags;
+
+typedef struct LB_FsChange {
+    const char *path_utf8; // relative to the watched directory
+    uint32_t flags;        // LB_FsChangeFlags, merged across the coalescing window
+} LB_FsChange;
+
+typedef void (*LB_FsWatchCallback)(const LB_FsChange *changes, size_t count, void *ctx);
+
+// Completion payload for the asynchronous fs_* variants.
+typedef struct LB_FsAsyncResult {
+    LB_ErrorCode error;
+    LB_Buffer buffer; // fs_read_async only; owned by the consumer, release with buffer_free
+    LB_FileStat stat; // fs_stat_async only
+} LB_FsAsyncResult;
+
+typedef void (*LB_FsAsyncCallback)(const LB_FsAsyncResult *result, void *ctx);
+
 typedef enum LB_NetMethod {
     LB_NetMethod_Get = 0,
     LB_NetMethod_Post,
@@ -165,6 +298,107 @@ typedef struct LB_NetHeader {
     const char *value;  // UTF-8
 } LB_NetHeader;
 
+// LB_NetRequestDesc::flags (bitmask).
+typedef enum LB_NetRequestFlags {
+    LB_NetRequestFlag_None       = 0,
+    LB_NetRequestFlag_BorrowBody = 1u << 0, // send `body` in place; keep it until the callback or cancel
+    LB_NetRequestFlag_NoCache    = 1u << 1, // neither read from nor store into the HTTP cache
+    LB_NetRequestFlag_Timing     = 1u << 2  // attach an LB_NetTiming to the response
+} LB_NetRequestFlags;
+
+// Scheduling priority for LB_NetRequestDesc::priority. Zero-initialized descriptors get Normal.
+typedef enum LB_NetPriority {
+    LB_NetPriority_Lowest  = -2, // speculative prefetches
+    LB_NetPriority_Low     = -1, // images and other non-blocking subresources
+    LB_NetPriority_Normal  = 0,
+    LB_NetPriority_High    = 1,
+    LB_NetPriority_Highest = 2   // render-blocking documents, styles and scripts
+} LB_NetPriority;
+
+#define LB_NET_PRIORITY_LEVELS 5
+
+// Scheduler metrics. Per-priority arrays are indexed by priority - LB_NetPriority_Lowest.
+typedef struct LB_NetSchedulerStats {
+    uint32_t queued; // waiting for a global or per-host slot right now
+    uint32_t active;
+    uint64_t dispatched[LB_NET_PRIORITY_LEVELS];
+    uint64_t total_queue_us[LB_NET_PRIORITY_LEVELS]; // summed time from submission to dispatch
+    uint64_t max_queue_us[LB_NET_PRIORITY_LEVELS];
+} LB_NetSchedulerStats;
+
+// Phases aggregated per origin by net_get_origin_timing.
+typedef enum LB_NetTimingPhase {
+    LB_NetTimingPhase_Queue = 0, // queued_us .. started_us
+    LB_NetTimingPhase_Dns,
+    LB_NetTimingPhase_Connect,
+    LB_NetTimingPhase_Tls,
+    LB_NetTimingPhase_Wait,      // request_start_us .. response_start_us (time to first byte)
+    LB_NetTimingPhase_Transfer,  // response_start_us .. response_end_us
+    LB_NetTimingPhase_Total      // queued_us .. response_end_us
+} LB_NetTimingPhase;
+
+#define LB_NET_TIMING_PHASES 7
+// Bucket 0 counts durations under 1 ms, bucket i durations in [2^(i-1), 2^i) ms, and the last
+// bucket everything from 2^(LB_NET_TIMING_BUCKETS - 2) ms up.
+#define LB_NET_TIMING_BUCKETS 16
+
+// Latency histograms for network round trips to one origin (cache hits are not counted).
+typedef struct LB_NetOriginTiming {
+    uint64_t requests;
+    uint64_t reused_connections;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t histogram[LB_NET_TIMING_PHASES][LB_NET_TIMING_BUCKETS]; // indexed by LB_NetTimingPhase
+} LB_NetOriginTiming;
+
+// net_preconnect flags (bitmask).
+typedef enum LB_NetPreconnectFlags {
+    LB_NetPreconnectFlag_None  = 0,
+    LB_NetPreconnectFlag_Probe = 1u << 0 // open connections with real "HEAD /" requests
+} LB_NetPreconnectFlags;
+
+// Counters for net_dns_prefetch and net_preconnect since startup.
+typedef struct LB_NetPreconnectStats {
+    uint64_t dns_prefetches;           // lookups started
+    uint64_t dns_prefetch_hits;        // requests to a host whose lookup had been prefetched
+    uint64_t preconnects;              // probe round trips issued
+    uint64_t warm_connections;         // new connections those round trips left open
+    uint64_t warm_connections_used;    // reused by a later request to the origin
+    uint64_t warm_connections_expired; // never reused before the server would close them
+} LB_NetPreconnectStats;
+
+// LB_NetDownloadDesc::flags (bitmask).
+typedef enum LB_NetDownloadFlags {
+    LB_NetDownloadFlag_None   = 0,
+    LB_NetDownloadFlag_Resume = 1u << 0 // continue an interrupted download of the same URL to the same path
+} LB_NetDownloadFlags;
+
+// Zero-initialize before filling in.
+typedef struct LB_NetDownloadDesc {
+    const char *url_utf8;
+    const char *path_utf8;      // destination; data is staged in "<path>.part" until complete
+    const LB_NetHeader *headers;
+    size_t header_count;
+    uint32_t flags;             // LB_NetDownloadFlags
+    uint32_t max_connections;   // parallel range requests when the server allows them; 0 or 1 = one
+    int32_t priority;           // LB_NetPriority
+} LB_NetDownloadDesc;
+
+// Both run on the event loop thread. Progress is coalesced, so not every chunk is reported;
+// `total` is 0 while the size is unknown. `http_status` is that of the last response, or 206 when
+// a resumed download turned out to be complete already.
+typedef struct LB_NetDownloadCallbacks {
+    void (*on_progress)(uint64_t received, uint64_t total, void *ctx);
+    void (*on_complete)(LB_ErrorCode error, uint32_t http_status, void *ctx);
+} LB_NetDownloadCallbacks;
+
+// Pulls the next piece of a streamed upload into `buffer` (at most `capacity` bytes) and
+// stores its length in `*out_size`; 0 marks the end of the body. Called on a network worker
+// thread. Returning an error aborts the request. Cancel does not wait for the provider; a call
+// that is already starting or running may finish after cancel returns, and its output is dropped.
+typedef LB_ErrorCode (*LB_NetBodyProvider)(uint8_t *buffer, size_t capacity, size_t *out_size, void *ctx);
+
+// Zero-initialize before filling in; fields added after `flags` default to off when zero.
 typedef struct LB_NetRequestDesc {
     LB_NetMethod method;
     const char *custom_method; // optional, used when method == LB_NetMethod_Custom
@@ -173,19 +407,74 @@ typedef struct LB_NetRequestDesc {
     size_t header_count;
     const uint8_t *body;
     size_t body_size;
-    uint32_t flags;
+    uint32_t flags; // LB_NetRequestFlags
+
+    // Streamed upload, used instead of `body` when set. A file is sent with its size as
+    // Content-Length; a provider with `body_length` (0 = unknown: chunked transfer encoding).
+    LB_NetBodyProvider body_provider;
+    void *body_provider_ctx;
+    uint64_t body_length;
+    const char *body_file_utf8;
+
+    int32_t priority; // LB_NetPriority
 } LB_NetRequestDesc;
 
+// Phase timestamps in microseconds on a monotonic clock; only differences are meaningful.
+// A timestamp is 0 when its phase did not happen, e.g. DNS and connect on a reused connection.
+typedef struct LB_NetTiming {
+    uint64_t queued_us;         // handed to the scheduler
+    uint64_t started_us;        // picked up by a worker
+    uint64_t dns_start_us;
+    uint64_t dns_end_us;
+    uint64_t connect_start_us;
+    uint64_t connect_end_us;    // TCP established; a TLS handshake starts here
+    uint64_t tls_end_us;        // handshake done, taken as the request starts going out
+    uint64_t request_start_us;
+    uint64_t request_end_us;    // request and body sent
+    uint64_t response_start_us; // response headers received
+    uint64_t response_end_us;   // body complete
+    uint64_t bytes_sent;        // request body bytes
+    uint64_t bytes_received;    // response body bytes
+    uint32_t connection_reused; // 1 when a kept-alive connection carried the request
+    uint32_t from_cache;        // 1 when served from the HTTP cache without a network round trip
+} LB_NetTiming;
+
 typedef struct LB_NetResponse {
     LB_ErrorCode error;
     uint32_t http_status;
     const LB_NetHeader *headers;
     size_t header_count;
     LB_Buffer body;
+    // Set with LB_NetRequestFlag_Timing; valid for the duration of the callback. Streaming
+    // requests get it in on_response, before the body is read, so the response_end_us and
+    // bytes_received fields are still 0 there.
+    const LB_NetTiming *timing;
 } LB_NetResponse;
 
 typedef void (*LB_NetResponseCallback)(const LB_NetResponse *response, void *ctx);
 
+// HTTP cache counters since net_cache_configure was first called.
+typedef struct LB_NetCacheStats {
+    uint64_t hits;          // fresh responses served without contacting the origin
+    uint64_t revalidations; // stale responses confirmed by a 304 Not Modified
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t evictions;     // memory and disk tiers combined
+    uint64_t bytes_saved;   // body bytes served from the cache instead of transferred
+    uint64_t memory_bytes;
+    uint64_t disk_bytes;
+} LB_NetCacheStats;
+
+// Callbacks for net_request_stream, all invoked on the event loop thread in this order:
+// on_response once (status and headers, empty body; ownership as for net_request), on_data for
+// each body chunk (`data` is only valid during the call), then on_complete exactly once.
+// A slow consumer throttles the transfer instead of buffering the whole body.
+typedef struct LB_NetStreamCallbacks {
+    void (*on_response)(const LB_NetResponse *response, void *ctx);
+    void (*on_data)(const uint8_t *data, size_t size, void *ctx);
+    void (*on_complete)(LB_ErrorCode error, void *ctx);
+} LB_NetStreamCallbacks;
+
 typedef struct LB_PlatformV1 {
     // Platform fills this with LB_PLATFORM_ABI_VERSION so the consumer can validate compatibility.
     uint32_t abi_version;
@@ -233,12 +522,126 @@ typedef struct LB_PlatformV1 {
     LB_ErrorCode (*clipboard_read_text)(LB_Buffer *out);
 
     // Networking helpers (WinHTTP-backed on Windows).
+    // The handle stays valid until the callback runs. net_request_cancel returns immediately; a
+    // transfer already on the wire stops at its next network event (at most the 30 s I/O timeout
+    // later). Cancelling from the event loop thread guarantees the callback will not fire, and the handle must not be used afterwards. gzip and deflate bodies are
+    // decoded on the network workers and arrive without Content-Encoding/Content-Length; sending
+    // an explicit Accept-Encoding header opts out and delivers the bytes as sent.
     LB_ErrorCode (*net_request)(const LB_NetRequestDesc *desc, LB_NetResponseCallback cb, void *ctx, lb_net_request **out_handle);
     void (*net_request_cancel)(lb_net_request *handle);
+
+    // Zero-copy read-only file mapping. `hints` is a mask of LB_MapHint values.
+    LB_ErrorCode (*fs_map_file)(const char *path_utf8, uint32_t hints, LB_MappedFile *out);
+    void (*fs_unmap_file)(LB_MappedFile *file);
+
+    // Asynchronous file helpers. Work runs on a small I/O pool and the callback fires on the
+    // event loop thread. Returns LB_Error_Busy once too many operations are in flight.
+    // The handle stays valid until the callback runs; cancelling from the event loop thread
+    // guarantees the callback will not fire.
+    LB_ErrorCode (*fs_read_async)(const char *path_utf8, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+    LB_ErrorCode (*fs_write_async)(const char *path_utf8, const void *data, size_t size, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+    LB_ErrorCode (*fs_stat_async)(const char *path_utf8, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+    void (*fs_request_cancel)(lb_fs_request *handle);
+
+    // Directory listing that keeps the size/timestamp/attributes reported by enumeration,
+    // avoiding a follow-up fs_stat per entry.
+    LB_ErrorCode (*fs_list_directory_ex)(const char *path_utf8, LB_DirectoryListingEx *out);
+
+    // Streaming directory enumeration in fixed-size batches. Each batch's buffer is owned by
+    // the iterator and stays valid until the next fs_dir_next_batch or fs_dir_close call.
+    // A batch with count == 0 marks the end of the directory.
+    LB_ErrorCode (*fs_dir_open)(const char *path_utf8, lb_dir_iterator **out);
+    LB_ErrorCode (*fs_dir_next_batch)(lb_dir_iterator *it, LB_DirectoryListingEx *out);
+    void (*fs_dir_close)(lb_dir_iterator *it);
+
+    // Recursive directory walk across a worker pool. Blocks until the walk completes;
+    // batches are delivered on the calling thread as they become available.
+    LB_ErrorCode (*fs_walk)(const char *root_utf8, const LB_WalkOptions *options, LB_WalkBatchCallback cb, void *ctx);
+
+    // Change notifications for a directory (optionally recursive) or a single file. Changes are
+    // coalesced per path and delivered in batches on the event loop thread. A watch that fails
+    // reports LB_FsChange_Error once and stays silent until unwatched. Call fs_unwatch from the
+    // event loop thread; no callback fires after it returns.
+    LB_ErrorCode (*fs_watch)(const char *path_utf8, int recursive, LB_FsWatchCallback cb, void *ctx, lb_fs_watch **out_handle);
+    void (*fs_unwatch)(lb_fs_watch *handle);
+
+    // Partial reads. fs_read_range returns up to `length` bytes starting at `offset` (shorter at
+    // end of file). fs_read_stream delivers [offset, offset + length) in chunks of `chunk_size`
+    // bytes on the calling thread with at most two chunks buffered; length 0 reads to end of file
+    // and chunk_size 0 picks a default.
+    LB_ErrorCode (*fs_read_range)(const char *path_utf8, uint64_t offset, size_t length, LB_FileResult *out);
+    LB_ErrorCode (*fs_read_stream)(const char *path_utf8, uint64_t offset, uint64_t length, size_t chunk_size, LB_FileChunkCallback cb, void *ctx);
+
+    // Warm the OS file cache for a set of files in parallel ahead of reading them. Returns
+    // immediately; `cb` (optional) fires once per path on the event loop thread.
+    LB_ErrorCode (*fs_prefetch)(const char *const *paths_utf8, size_t count, LB_FsPrefetchCallback cb, void *ctx);
+
+    // Opt-in LRU cache of file contents keyed by path, revalidated against the file's size and
+    // last-write time on each read. Capacity defaults to 0 (disabled: every read is a miss).
+    void (*fs_cache_configure)(uint64_t capacity_bytes);
+    LB_ErrorCode (*fs_cache_read)(const char *path_utf8, LB_CachedFile *out);
+    void (*fs_cache_release)(LB_CachedFile *file);
+    void (*fs_cache_get_stats)(LB_FileCacheStats *out);
+
+    // Read-only resource bundles produced by lbw_bundle_pack (see lb_bundle_format.h). The
+    // bundle is mapped once; lookups take '/'-separated paths relative to the packed directory
+    // and return slices of the mapping.
+    LB_ErrorCode (*bundle_open)(const char *path_utf8, lb_bundle **out);
+    LB_ErrorCode (*bundle_lookup)(lb_bundle *bundle, const char *resource_path_utf8, LB_BundleSlice *out);
+    void (*bundle_close)(lb_bundle *bundle);
+
+    // Whole-file writes with explicit durability. `flags` is a mask of LB_WriteFlags. With
+    // LB_WriteFlag_Atomic readers see either the old or the new contents, never a partial file.
+    // Group-commit writes queue behind the commit cycle in progress and are written and flushed
+    // together in the next one; the callback fires once its cycle is durable.
+    LB_ErrorCode (*fs_write_file_ex)(const char *path_utf8, const void *data, size_t size, uint32_t flags);
+    LB_ErrorCode (*fs_write_async_ex)(const char *path_utf8, const void *data, size_t size, uint32_t flags, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+
+    // Streaming variant of net_request; `on_complete` is required. The handle stays valid until
+    // on_complete runs and is cancelled with net_request_cancel, after which no callback fires.
+    LB_ErrorCode (*net_request_stream)(const LB_NetRequestDesc *desc, const LB_NetStreamCallbacks *callbacks, void *ctx, lb_net_request **out_handle);
+
+    // HTTP cache for buffered GET requests: an in-memory LRU tier plus an optional disk tier in
+    // `disk_dir_utf8` (created if missing). Honors Cache-Control/Expires freshness, revalidates
+    // stale entries with ETag/Last-Modified and serves 304s from the stored body. Disabled
+    // until configured; zero sizes disable the respective tier.
+    LB_ErrorCode (*net_cache_configure)(const char *disk_dir_utf8, uint64_t memory_bytes, uint64_t disk_bytes);
+    void (*net_cache_get_stats)(LB_NetCacheStats *out);
+
+    // Requests are dispatched by priority under global and per-host concurrency limits.
+    // set_priority moves a still-queued request; it has no effect once the request is running.
+    void (*net_request_set_priority)(lb_net_request *handle, int32_t priority);
+    void (*net_get_scheduler_stats)(LB_NetSchedulerStats *out);
+
+    // Timing histograms for the host and port of `url_utf8`. Returns
+    // LB_Error_NotFound when no request to it has completed yet.
+    LB_ErrorCode (*net_get_origin_timing)(const char *url_utf8, LB_NetOriginTiming *out);
+
+    // Speculative warm-up for origins the consumer expects to need soon. dns_prefetch resolves
+    // `host_utf8` in the background so a later connect finds it in the system resolver cache.
+    // preconnect warms the origin of `origin_utf8` (e.g. "https://example.com"): by default it
+    // only prefetches the host's DNS, since WinHTTP cannot open a connection without sending a
+    // request. LB_NetPreconnectFlag_Probe opts in to opening up to `count` kept-alive
+    // connections with "HEAD /" requests at low priority; the server sees, logs and rate-limits
+    // those like any other request. Both return without waiting.
+    LB_ErrorCode (*net_dns_prefetch)(const char *host_utf8);
+    LB_ErrorCode (*net_preconnect)(const char *origin_utf8, uint32_t count, uint32_t flags);
+    void (*net_get_preconnect_stats)(LB_NetPreconnectStats *out);
+
+    // Streams a response body straight to disk with bounded buffering; `on_complete` is required.
+    // Interrupted transfers are retried with Range requests, and a download that fails or is
+    // cancelled leaves "<path>.part" behind for LB_NetDownloadFlag_Resume. The handle stays valid
+    // until on_complete runs; cancelling from the event loop thread guarantees no callback fires.
+    LB_ErrorCode (*net_download)(const LB_NetDownloadDesc *desc, const LB_NetDownloadCallbacks *callbacks, void *ctx, lb_net_download **out_handle);
+    void (*net_download_cancel)(lb_net_download *handle);
 } LB_PlatformV1;
 
 typedef LB_ErrorCode (*LB_QueryPlatformV1Fn)(LB_PlatformV1 *out);
 
+// Exported as LB_QueryPlatform. `out_size` is sizeof(LB_PlatformV1) as the host was built; the
+// platform copies no more than that and zeroes entries the host knows about but it lacks.
+typedef LB_ErrorCode (*LB_QueryPlatformFn)(LB_PlatformV1 *out, size_t out_size);
+
 // Simple logging helper (implemented by the platform backend).
 void lbw_log(const char *fmt, ...);
 
@@ -0,0 +1,104 @@
+#include <windows.h>
+
+#include <cstring>
+
+#include "lb_platform.h"
+#include "lb_bundle_format.h"
+
+extern "C" LB_ErrorCode fs_map_file_impl(const char *path_utf8, uint32_t hints, LB_MappedFile *out);
+extern "C" void fs_unmap_file_impl(LB_MappedFile *file);
+
+struct lb_bundle {
+    LB_MappedFile mapping{};
+    const LB_BundleHeader *header{};
+    const uint32_t *seeds{};
+    const LB_BundleEntry *entries{};
+    const char *names{};
+    uint64_t names_size{};
+};
+
+static bool range_fits(uint64_t offset, uint64_t size, uint64_t total) {
+    return offset <= total && size <= total - offset;
+}
+
+extern "C" LB_ErrorCode bundle_open_impl(const char *path_utf8, lb_bundle **out) {
+    if (!path_utf8 || !out) {
+        return LB_Error_BadArgument;
+    }
+    *out = nullptr;
+
+    LB_MappedFile mapping{};
+    LB_ErrorCode rc = fs_map_file_impl(path_utf8, LB_MapHint_Random, &mapping);
+    if (rc != LB_Error_Ok) {
+        return rc;
+    }
+
+    // Validate the fixed tables up front; per-entry ranges are checked on lookup.
+    const uint64_t size = mapping.size;
+    const auto *header = reinterpret_cast<const LB_BundleHeader *>(mapping.data);
+    bool valid = size >= sizeof(LB_BundleHeader) &&
+                 header->magic == LB_BUNDLE_MAGIC &&
+                 header->version == LB_BUNDLE_VERSION &&
+                 header->bucket_count > 0 &&
+                 header->file_size <= size &&
+                 range_fits(header->seeds_offset, sizeof(uint32_t) * static_cast<uint64_t>(header->bucket_count), size) &&
+                 range_fits(header->entries_offset, sizeof(LB_BundleEntry) * static_cast<uint64_t>(header->entry_count), size) &&
+                 header->names_offset <= size &&
+                 header->seeds_offset % alignof(uint32_t) == 0 &&
+                 header->entries_offset % alignof(LB_BundleEntry) == 0;
+    if (!valid) {
+        fs_unmap_file_impl(&mapping);
+        return LB_Error_NotSupported;
+    }
+
+    auto *bundle = new lb_bundle{};
+    bundle->mapping = mapping;
+    bundle->header = header;
+    bundle->seeds = reinterpret_cast<const uint32_t *>(mapping.data + header->seeds_offset);
+    bundle->entries = reinterpret_cast<const LB_BundleEntry *>(mapping.data + header->entries_offset);
+    bundle->names = reinterpret_cast<const char *>(mapping.data + header->names_offset);
+    bundle->names_size = size - header->names_offset;
+    *out = bundle;
+    return LB_Error_Ok;
+}
+
+extern "C" LB_ErrorCode bundle_lookup_impl(lb_bundle *bundle, const char *resource_path_utf8, LB_BundleSlice *out) {
+    if (!bundle || !resource_path_utf8 || !out) {
+        return LB_Error_BadArgument;
+    }
+    out->data = nullptr;
+    out->size = 0;
+
+    const LB_BundleHeader *header = bundle->header;
+    if (header->entry_count == 0) {
+        return LB_Error_NotFound;
+    }
+
+    size_t length = strlen(resource_path_utf8);
+    uint32_t bucket = static_cast<uint32_t>(lb_bundle_hash(resource_path_utf8, length, 0) % header->bucket_count);
+    uint32_t slot = static_cast<uint32_t>(lb_bundle_hash(resource_path_utf8, length, bundle->seeds[bucket]) % header->entry_count);
+    const LB_BundleEntry &entry = bundle->entries[slot];
+
+    // The perfect hash maps every stored path to a unique slot, but unknown paths land on
+    // arbitrary slots; the name comparison rejects them.
+    if (entry.name_length != length ||
+        !range_fits(entry.name_offset, entry.name_length, bundle->names_size) ||
+        memcmp(bundle->names + entry.name_offset, resource_path_utf8, length) != 0) {
+        return LB_Error_NotFound;
+    }
+    if (!range_fits(entry.data_offset, entry.data_size, bundle->mapping.size)) {
+        return LB_Error_NotSupported;
+    }
+
+    out->data = bundle->mapping.data + entry.data_offset;
+    out->size = static_cast<size_t>(entry.data_size);
+    return LB_Error_Ok;
+}
+
+extern "C" void bundle_close_impl(lb_bundle *bundle) {
+    if (!bundle) {
+        return;
+    }
+    fs_unmap_file_impl(&bundle->mapping);
+    delete bundle;
+}
@@ -6,24 +6,7 @@
 #include <objbase.h>
 
 #include "lb_platform.h"
-
-static std::wstring utf8_to_wide(const char *s, size_t length) {
-    if (!s) return {};
-    int len = MultiByteToWideChar(CP_UTF8, 0, s, static_cast<int>(length), nullptr, 0);
-    if (len <= 0) return {};
-    std::wstring out(static_cast<size_t>(len), L'\0');
-    MultiByteToWideChar(CP_UTF8, 0, s, static_cast<int>(length), out.data(), len);
-    return out;
-}
-
-static std::string wide_to_utf8(const wchar_t *s, size_t length) {
-    if (!s) return {};
-    int len = WideCharToMultiByte(CP_UTF8, 0, s, static_cast<int>(length), nullptr, 0, nullptr, nullptr);
-    if (len <= 0) return {};
-    std::string out(static_cast<size_t>(len), '\0');
-    WideCharToMultiByte(CP_UTF8, 0, s, static_cast<int>(length), out.data(), len, nullptr, nullptr);
-    return out;
-}
+#include "win_utf.h"
 
 extern "C" LB_ErrorCode clipboard_write_text_impl(const char *utf8, size_t length) {
     if (!utf8 && length > 0) {
@@ -37,7 +20,7 @@ extern "C" LB_ErrorCode clipboard_write_text_impl(const char *utf8, size_t lengt
         return LB_Error_Unknown;
     }
 
-    std::wstring wide = utf8_to_wide(utf8, length ? length : (utf8 ? strlen(utf8) : 0));
+    std::wstring wide = lbw_utf8_to_wide(utf8, length ? length : (utf8 ? strlen(utf8) : 0));
     wide.push_back(L'\0');
 
     SIZE_T bytes = wide.size() * sizeof(wchar_t);
@@ -84,7 +67,7 @@ extern "C" LB_ErrorCode clipboard_read_text_impl(LB_Buffer *out) {
         return LB_Error_Unknown;
     }
     size_t len = wcslen(wtext);
-    std::string utf8 = wide_to_utf8(wtext, len);
+    std::string utf8 = lbw_wide_to_utf8(wtext, len);
     GlobalUnlock(hdata);
     CloseClipboard();
 
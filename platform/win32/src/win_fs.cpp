@@ -1,37 +1,15 @@
 #include <windows.h>
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <cstring>
 #include <objbase.h>
 
 #include "lb_platform.h"
-
-static std::wstring utf8_to_wide(const char *s) {
-    if (!s) {
-        return {};
-    }
-    int len = MultiByteToWideChar(CP_UTF8, 0, s, -1, nullptr, 0);
-    if (len <= 0) {
-        return {};
-    }
-    std::wstring out(static_cast<size_t>(len - 1), L'\0');
-    if (len > 1) {
-        MultiByteToWideChar(CP_UTF8, 0, s, -1, out.data(), len);
-    }
-    return out;
-}
-
-static std::string wide_to_utf8(const wchar_t *s) {
-    if (!s) return {};
-    int len = WideCharToMultiByte(CP_UTF8, 0, s, -1, nullptr, 0, nullptr, nullptr);
-    if (len <= 0) return {};
-    std::string out(static_cast<size_t>(len - 1), '\0');
-    if (len > 1) {
-        WideCharToMultiByte(CP_UTF8, 0, s, -1, out.data(), len, nullptr, nullptr);
-    }
-    return out;
-}
+#include "win_fs_internal.h"
+#include "win_utf.h"
 
 extern "C" void lbw_buffer_free_impl(void *ptr) {
     if (ptr) {
@@ -102,50 +80,346 @@ extern "C" LB_ErrorCode fs_read_entire_file_impl(const char *path_utf8, LB_FileR
     if (!path_utf8 || !out) {
         return LB_Error_BadArgument;
     }
-    std::wstring path = utf8_to_wide(path_utf8);
+    WideStackString path(path_utf8);
     if (path.empty()) {
         return LB_Error_BadArgument;
     }
     return read_file_into_buffer(path.c_str(), out);
 }
 
-extern "C" LB_ErrorCode fs_write_entire_file_impl(const char *path_utf8, const void *data, size_t size) {
-    if (!path_utf8 || (!data && size > 0)) {
+// Default chunk size for fs_read_stream.
+static const size_t kReadStreamChunkBytes = 256 * 1024;
+
+static void set_overlapped_offset(OVERLAPPED &ov, uint64_t offset) {
+    ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+}
+
+extern "C" LB_ErrorCode fs_read_range_impl(const char *path_utf8, uint64_t offset, size_t length, LB_FileResult *out) {
+    if (!path_utf8 || !out) {
         return LB_Error_BadArgument;
     }
-    std::wstring path = utf8_to_wide(path_utf8);
+    out->buffer.data = nullptr;
+    out->buffer.size = 0;
+
+    WideStackString path(path_utf8);
     if (path.empty()) {
         return LB_Error_BadArgument;
     }
 
-    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
-                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_RANDOM_ACCESS, nullptr);
     if (file == INVALID_HANDLE_VALUE) {
         return LB_Error_Unknown;
     }
 
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return LB_Error_Unknown;
+    }
+    uint64_t file_size = static_cast<uint64_t>(size.QuadPart);
+    if (offset >= file_size || length == 0) {
+        CloseHandle(file);
+        return LB_Error_Ok;
+    }
+    size_t byte_size = static_cast<size_t>(std::min<uint64_t>(length, file_size - offset));
+
+    uint8_t *buffer = static_cast<uint8_t *>(CoTaskMemAlloc(byte_size));
+    if (!buffer) {
+        CloseHandle(file);
+        return LB_Error_OutOfMemory;
+    }
+
+    size_t total_read = 0;
+    while (total_read < byte_size) {
+        // Positional read on a synchronous handle: the OVERLAPPED only carries the offset.
+        OVERLAPPED ov{};
+        set_overlapped_offset(ov, offset + total_read);
+        DWORD want = static_cast<DWORD>(std::min<size_t>(byte_size - total_read, MAXDWORD));
+        DWORD chunk = 0;
+        if (!ReadFile(file, buffer + total_read, want, &chunk, &ov)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) {
+                break;
+            }
+            CloseHandle(file);
+            lbw_buffer_free_impl(buffer);
+            return LB_Error_Unknown;
+        }
+        if (chunk == 0) {
+            break;
+        }
+        total_read += chunk;
+    }
+
+    CloseHandle(file);
+    out->buffer.data = buffer;
+    out->buffer.size = total_read;
+    return LB_Error_Ok;
+}
+
+extern "C" LB_ErrorCode fs_read_stream_impl(const char *path_utf8, uint64_t offset, uint64_t length, size_t chunk_size,
+                                            LB_FileChunkCallback cb, void *ctx) {
+    if (!path_utf8 || !cb) {
+        return LB_Error_BadArgument;
+    }
+    WideStackString path(path_utf8);
+    if (path.empty()) {
+        return LB_Error_BadArgument;
+    }
+    if (chunk_size == 0) {
+        chunk_size = kReadStreamChunkBytes;
+    }
+    chunk_size = std::min<size_t>(chunk_size, MAXDWORD);
+    uint64_t remaining = length ? length : UINT64_MAX;
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return LB_Error_Unknown;
+    }
+
+    // Two slots: the next chunk is read while the callback consumes the current one.
+    std::vector<uint8_t> buffers[2];
+    OVERLAPPED ov[2]{};
+    bool in_flight[2]{};
+    LB_ErrorCode result = LB_Error_Ok;
+    for (int i = 0; i < 2; ++i) {
+        ov[i].hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!ov[i].hEvent) {
+            result = LB_Error_Unknown;
+        }
+    }
+
+    auto issue_read = [&](int slot, uint64_t position) -> bool {
+        DWORD want = static_cast<DWORD>(std::min<uint64_t>(remaining, chunk_size));
+        if (buffers[slot].size() < want) {
+            buffers[slot].resize(want);
+        }
+        ResetEvent(ov[slot].hEvent);
+        set_overlapped_offset(ov[slot], position);
+        if (!ReadFile(file, buffers[slot].data(), want, nullptr, &ov[slot])) {
+            DWORD err = GetLastError();
+            if (err == ERROR_HANDLE_EOF) {
+                return false;
+            }
+            if (err != ERROR_IO_PENDING) {
+                result = LB_Error_Unknown;
+                return false;
+            }
+        }
+        in_flight[slot] = true;
+        return true;
+    };
+
+    uint64_t position = offset;
+    int current = 0;
+    if (result == LB_Error_Ok) {
+        issue_read(current, position);
+    }
+
+    while (result == LB_Error_Ok && in_flight[current]) {
+        DWORD got = 0;
+        BOOL ok = GetOverlappedResult(file, &ov[current], &got, TRUE);
+        in_flight[current] = false;
+        if (!ok) {
+            if (GetLastError() != ERROR_HANDLE_EOF) {
+                result = LB_Error_Unknown;
+            }
+            break;
+        }
+        if (got == 0) {
+            break;
+        }
+
+        uint64_t chunk_offset = position;
+        position += got;
+        remaining -= std::min<uint64_t>(remaining, got);
+        int next = current ^ 1;
+        if (remaining > 0) {
+            issue_read(next, position);
+        }
+
+        if (cb(buffers[current].data(), got, chunk_offset, ctx) != 0) {
+            break;
+        }
+        current = next;
+    }
+
+    // Drain a read that is still outstanding before its buffer goes away.
+    for (int i = 0; i < 2; ++i) {
+        if (in_flight[i]) {
+            DWORD ignored = 0;
+            CancelIoEx(file, &ov[i]);
+            GetOverlappedResult(file, &ov[i], &ignored, TRUE);
+        }
+        if (ov[i].hEvent) {
+            CloseHandle(ov[i].hEvent);
+        }
+    }
+    CloseHandle(file);
+    return result;
+}
+
+static std::atomic<uint32_t> g_staged_write_counter{0};
+
+HANDLE lbw_fs_begin_write(const wchar_t *target, bool atomic, std::wstring &staged_path) {
+    staged_path.clear();
+    if (!atomic) {
+        return CreateFileW(target, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+    // Stage next to the target so the final rename never crosses volumes.
+    staged_path = target;
+    staged_path += L".";
+    staged_path += std::to_wstring(GetCurrentProcessId());
+    staged_path += L"-";
+    staged_path += std::to_wstring(g_staged_write_counter.fetch_add(1));
+    staged_path += L".lbtmp";
+    HANDLE file = CreateFileW(staged_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        staged_path.clear();
+    }
+    return file;
+}
+
+bool lbw_fs_write_all(HANDLE file, const void *data, size_t size) {
     const uint8_t *bytes = static_cast<const uint8_t *>(data);
     size_t remaining = size;
     while (remaining > 0) {
         DWORD written = 0;
         DWORD to_write = remaining > MAXDWORD ? MAXDWORD : static_cast<DWORD>(remaining);
         if (!WriteFile(file, bytes, to_write, &written, nullptr)) {
-            CloseHandle(file);
-            return LB_Error_Unknown;
+            return false;
         }
         bytes += written;
         remaining -= written;
     }
+    return true;
+}
+
+static bool is_path_separator(wchar_t c) {
+    return c == L'\\' || c == L'/';
+}
+
+void lbw_fs_trim_trailing_separators(std::wstring &path) {
+    size_t end = path.size();
+    while (end > 1 && is_path_separator(path[end - 1])) {
+        --end;
+    }
+    if (end == path.size()) {
+        return;
+    }
+
+    // Find where the root starts once any "\\?\" or "\\?\UNC\" prefix is skipped.
+    size_t start = 0;
+    bool unc = false;
+    if (path.compare(0, 4, L"\\\\?\\") == 0) {
+        start = 4;
+        if (path.compare(4, 4, L"UNC\\") == 0) {
+            start = 8;
+            unc = true;
+        }
+    } else if (end >= 2 && is_path_separator(path[0]) && is_path_separator(path[1])) {
+        start = 2;
+        unc = true;
+    }
+
+    bool root = false;
+    if (unc) {
+        // "server\share" with nothing after the share name.
+        size_t separators = 0;
+        for (size_t i = start; i < end; ++i) {
+            separators += is_path_separator(path[i]) ? 1 : 0;
+        }
+        root = separators == 1;
+    } else {
+        root = end - start == 2 && path[start + 1] == L':';
+    }
+    path.resize(root ? end + 1 : end);
+}
+
+// ReplaceFileW has no write-through option, so a flushed replace also flushes the directory
+// that holds the renamed entry. Filesystems that refuse directory flushes only get a log line.
+static void flush_parent_directory(const wchar_t *target) {
+    std::wstring directory = target;
+    size_t slash = directory.find_last_of(L"\\/");
+    if (slash == std::wstring::npos) {
+        directory = L".";
+    } else {
+        directory.resize(slash + 1);
+        lbw_fs_trim_trailing_separators(directory);
+    }
+    HANDLE handle = CreateFileW(directory.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE || !FlushFileBuffers(handle)) {
+        lbw_log("lb_platform: directory flush after replace failed (err=%lu)", static_cast<unsigned long>(GetLastError()));
+    }
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+    }
+}
 
+LB_ErrorCode lbw_fs_finish_write(HANDLE file, const wchar_t *target, const std::wstring &staged_path, bool flush) {
+    bool ok = !flush || FlushFileBuffers(file);
     CloseHandle(file);
+    if (staged_path.empty()) {
+        return ok ? LB_Error_Ok : LB_Error_Unknown;
+    }
+    if (ok) {
+        // ReplaceFileW keeps the target's attributes and ACLs; it fails when there is no target
+        // yet, in which case a plain rename is enough.
+        ok = ReplaceFileW(target, staged_path.c_str(), nullptr, REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr);
+        if (ok && flush) {
+            flush_parent_directory(target);
+        } else if (!ok) {
+            DWORD move_flags = MOVEFILE_REPLACE_EXISTING | (flush ? MOVEFILE_WRITE_THROUGH : 0);
+            ok = MoveFileExW(staged_path.c_str(), target, move_flags);
+        }
+    }
+    if (!ok) {
+        DeleteFileW(staged_path.c_str());
+        return LB_Error_Unknown;
+    }
     return LB_Error_Ok;
 }
 
+void lbw_fs_abort_write(HANDLE file, const std::wstring &staged_path) {
+    CloseHandle(file);
+    if (!staged_path.empty()) {
+        DeleteFileW(staged_path.c_str());
+    }
+}
+
+extern "C" LB_ErrorCode fs_write_file_ex_impl(const char *path_utf8, const void *data, size_t size, uint32_t flags) {
+    if (!path_utf8 || (!data && size > 0)) {
+        return LB_Error_BadArgument;
+    }
+    WideStackString path(path_utf8);
+    if (path.empty()) {
+        return LB_Error_BadArgument;
+    }
+
+    std::wstring staged_path;
+    HANDLE file = lbw_fs_begin_write(path.c_str(), (flags & LB_WriteFlag_Atomic) != 0, staged_path);
+    if (file == INVALID_HANDLE_VALUE) {
+        return LB_Error_Unknown;
+    }
+    if (!lbw_fs_write_all(file, data, size)) {
+        lbw_fs_abort_write(file, staged_path);
+        return LB_Error_Unknown;
+    }
+    return lbw_fs_finish_write(file, path.c_str(), staged_path, (flags & LB_WriteFlag_Flush) != 0);
+}
+
+extern "C" LB_ErrorCode fs_write_entire_file_impl(const char *path_utf8, const void *data, size_t size) {
+    return fs_write_file_ex_impl(path_utf8, data, size, LB_WriteFlag_None);
+}
+
 extern "C" LB_ErrorCode fs_remove_file_impl(const char *path_utf8) {
     if (!path_utf8) {
         return LB_Error_BadArgument;
     }
-    std::wstring path = utf8_to_wide(path_utf8);
+    WideStackString path(path_utf8);
     if (path.empty()) {
         return LB_Error_BadArgument;
     }
@@ -178,7 +452,7 @@ extern "C" LB_ErrorCode fs_stat_impl(const char *path_utf8, LB_FileStat *out) {
     if (!path_utf8 || !out) {
         return LB_Error_BadArgument;
     }
-    std::wstring path = utf8_to_wide(path_utf8);
+    WideStackString path(path_utf8);
     if (path.empty()) {
         return LB_Error_BadArgument;
     }
@@ -190,22 +464,31 @@ extern "C" LB_ErrorCode fs_stat_impl(const char *path_utf8, LB_FileStat *out) {
     return LB_Error_Ok;
 }
 
+static std::wstring directory_search_pattern(const WideStackString &path) {
+    std::wstring pattern(path.c_str(), path.size());
+    if (!pattern.empty()) {
+        if (pattern.back() != L'\\' && pattern.back() != L'/') {
+            pattern.push_back(L'\\');
+        }
+    }
+    pattern.append(L"*");
+    return pattern;
+}
+
+static bool is_dot_entry(const wchar_t *name) {
+    return wcscmp(name, L".") == 0 || wcscmp(name, L"..") == 0;
+}
+
 extern "C" LB_ErrorCode fs_list_directory_impl(const char *path_utf8, LB_DirectoryListing *out) {
     if (!path_utf8 || !out) {
         return LB_Error_BadArgument;
     }
-    std::wstring path = utf8_to_wide(path_utf8);
+    WideStackString path(path_utf8);
     if (path.empty()) {
         return LB_Error_BadArgument;
     }
 
-    std::wstring pattern = path;
-    if (!pattern.empty()) {
-        if (pattern.back() != L'\\' && pattern.back() != L'/') {
-            pattern.push_back(L'\\');
-        }
-    }
-    pattern.append(L"*");
+    std::wstring pattern = directory_search_pattern(path);
 
     WIN32_FIND_DATAW data;
     HANDLE hFind = FindFirstFileW(pattern.c_str(), &data);
@@ -219,10 +502,10 @@ extern "C" LB_ErrorCode fs_list_directory_impl(const char *path_utf8, LB_Directo
     std::vector<std::string> names;
     size_t total_bytes = 1; // final double null terminator
     do {
-        if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0) {
+        if (is_dot_entry(data.cFileName)) {
             continue;
         }
-        std::string u8 = wide_to_utf8(data.cFileName);
+        std::string u8 = lbw_wide_to_utf8(data.cFileName);
         names.push_back(u8);
         total_bytes += u8.size() + 1;
     } while (FindNextFileW(hFind, &data));
@@ -261,3 +544,258 @@ extern "C" LB_ErrorCode fs_list_directory_impl(const char *path_utf8, LB_Directo
     out->count = names.size();
     return LB_Error_Ok;
 }
+
+static void populate_entry_from_find_data(const WIN32_FIND_DATAW &data, LB_DirectoryEntry *out) {
+    ULARGE_INTEGER size{};
+    size.HighPart = data.nFileSizeHigh;
+    size.LowPart = data.nFileSizeLow;
+    ULARGE_INTEGER ft{};
+    ft.HighPart = data.ftLastWriteTime.dwHighDateTime;
+    ft.LowPart = data.ftLastWriteTime.dwLowDateTime;
+    out->size = size.QuadPart;
+    out->modified_timestamp = ft.QuadPart;
+    out->attributes = data.dwFileAttributes;
+    out->is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? 1 : 0;
+    out->reserved[0] = out->reserved[1] = out->reserved[2] = 0;
+}
+
+extern "C" LB_ErrorCode fs_list_directory_ex_impl(const char *path_utf8, LB_DirectoryListingEx *out) {
+    if (!path_utf8 || !out) {
+        return LB_Error_BadArgument;
+    }
+    out->buffer.data = nullptr;
+    out->buffer.size = 0;
+    out->entries = nullptr;
+    out->count = 0;
+
+    WideStackString path(path_utf8);
+    if (path.empty()) {
+        return LB_Error_BadArgument;
+    }
+
+    std::wstring pattern = directory_search_pattern(path);
+
+    // Basic info skips the 8.3 short name lookup, large fetch batches the directory reads.
+    WIN32_FIND_DATAW data;
+    HANDLE hFind = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch,
+                                    nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        return LB_Error_Unknown;
+    }
+
+    // Names are accumulated into one block with offsets relative to the block; they are
+    // rebased past the entry array once the final count is known.
+    std::vector<LB_DirectoryEntry> entries;
+    std::string names;
+    do {
+        if (is_dot_entry(data.cFileName)) {
+            continue;
+        }
+        size_t wide_length = wcslen(data.cFileName);
+        size_t capacity = lbw_wide_to_utf8_max(wide_length) + 1;
+        LB_DirectoryEntry entry{};
+        populate_entry_from_find_data(data, &entry);
+        entry.name_offset = names.size();
+        names.resize(entry.name_offset + capacity);
+        entry.name_length = lbw_wide_to_utf8_into(data.cFileName, wide_length, names.data() + entry.name_offset, capacity);
+        names.resize(entry.name_offset + entry.name_length + 1);
+        entries.push_back(entry);
+    } while (FindNextFileW(hFind, &data));
+
+    FindClose(hFind);
+
+    if (entries.empty()) {
+        return LB_Error_Ok;
+    }
+
+    size_t table_bytes = entries.size() * sizeof(LB_DirectoryEntry);
+    size_t total_bytes = table_bytes + names.size();
+    uint8_t *mem = static_cast<uint8_t *>(CoTaskMemAlloc(total_bytes));
+    if (!mem) {
+        return LB_Error_OutOfMemory;
+    }
+    for (auto &entry : entries) {
+        entry.name_offset += table_bytes;
+    }
+    memcpy(mem, entries.data(), table_bytes);
+    memcpy(mem + table_bytes, names.data(), names.size());
+
+    out->buffer.data = mem;
+    out->buffer.size = total_bytes;
+    out->entries = reinterpret_cast<const LB_DirectoryEntry *>(mem);
+    out->count = entries.size();
+    return LB_Error_Ok;
+}
+
+// Entries per fs_dir_next_batch call and the name space reserved for them. The name block
+// always has room for at least one maximum-length name (MAX_PATH UTF-16 units -> UTF-8).
+static const size_t kDirBatchEntries = 256;
+static const size_t kDirBatchNameBytes = 64 * 1024;
+
+struct lb_dir_iterator {
+    HANDLE find{INVALID_HANDLE_VALUE};
+    WIN32_FIND_DATAW pending{};
+    bool has_pending{};
+    std::vector<uint8_t> storage;
+};
+
+extern "C" LB_ErrorCode fs_dir_open_impl(const char *path_utf8, lb_dir_iterator **out) {
+    if (!path_utf8 || !out) {
+        return LB_Error_BadArgument;
+    }
+    *out = nullptr;
+    WideStackString path(path_utf8);
+    if (path.empty()) {
+        return LB_Error_BadArgument;
+    }
+
+    std::wstring pattern = directory_search_pattern(path);
+    auto *it = new lb_dir_iterator{};
+    it->find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &it->pending, FindExSearchNameMatch,
+                                nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (it->find == INVALID_HANDLE_VALUE) {
+        delete it;
+        return LB_Error_Unknown;
+    }
+    it->has_pending = true;
+    it->storage.resize(kDirBatchEntries * sizeof(LB_DirectoryEntry) + kDirBatchNameBytes);
+    *out = it;
+    return LB_Error_Ok;
+}
+
+extern "C" LB_ErrorCode fs_dir_next_batch_impl(lb_dir_iterator *it, LB_DirectoryListingEx *out) {
+    if (!it || !out) {
+        return LB_Error_BadArgument;
+    }
+
+    const size_t table_bytes = kDirBatchEntries * sizeof(LB_DirectoryEntry);
+    auto *entries = reinterpret_cast<LB_DirectoryEntry *>(it->storage.data());
+    char *names = reinterpret_cast<char *>(it->storage.data() + table_bytes);
+    size_t count = 0;
+    size_t names_used = 0;
+
+    while (it->has_pending && count < kDirBatchEntries) {
+        const WIN32_FIND_DATAW &data = it->pending;
+        if (!is_dot_entry(data.cFileName)) {
+            size_t wide_length = wcslen(data.cFileName);
+            size_t capacity = lbw_wide_to_utf8_max(wide_length) + 1;
+            if (names_used + capacity > kDirBatchNameBytes) {
+                // Keep the entry pending for the next batch.
+                break;
+            }
+            LB_DirectoryEntry &entry = entries[count++];
+            populate_entry_from_find_data(data, &entry);
+            entry.name_offset = table_bytes + names_used;
+            entry.name_length = lbw_wide_to_utf8_into(data.cFileName, wide_length, names + names_used, capacity);
+            names_used += entry.name_length + 1;
+        }
+        it->has_pending = FindNextFileW(it->find, &it->pending) != FALSE;
+    }
+
+    out->buffer.data = it->storage.data();
+    out->buffer.size = table_bytes + names_used;
+    out->entries = entries;
+    out->count = count;
+    return LB_Error_Ok;
+}
+
+extern "C" void fs_dir_close_impl(lb_dir_iterator *it) {
+    if (!it) {
+        return;
+    }
+    if (it->find != INVALID_HANDLE_VALUE) {
+        FindClose(it->find);
+    }
+    delete it;
+}
+
+using PrefetchVirtualMemoryFn = BOOL(WINAPI *)(HANDLE, ULONG_PTR, PWIN32_MEMORY_RANGE_ENTRY, ULONG);
+
+static PrefetchVirtualMemoryFn resolve_prefetch_virtual_memory() {
+    // PrefetchVirtualMemory is Windows 8+; resolve lazily so older systems just skip the hint.
+    static PrefetchVirtualMemoryFn fn = []() -> PrefetchVirtualMemoryFn {
+        HMODULE kernel32 = GetModuleHandleW(L"kernel32.dll");
+        if (!kernel32) {
+            return nullptr;
+        }
+        return reinterpret_cast<PrefetchVirtualMemoryFn>(GetProcAddress(kernel32, "PrefetchVirtualMemory"));
+    }();
+    return fn;
+}
+
+extern "C" LB_ErrorCode fs_map_file_impl(const char *path_utf8, uint32_t hints, LB_MappedFile *out) {
+    if (!path_utf8 || !out) {
+        return LB_Error_BadArgument;
+    }
+    out->data = nullptr;
+    out->size = 0;
+
+    WideStackString path(path_utf8);
+    if (path.empty()) {
+        return LB_Error_BadArgument;
+    }
+
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (hints & LB_MapHint_Sequential) {
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    } else if (hints & LB_MapHint_Random) {
+        flags |= FILE_FLAG_RANDOM_ACCESS;
+    }
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return LB_Error_Unknown;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return LB_Error_Unknown;
+    }
+    if (size.QuadPart < 0 || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        return LB_Error_NotSupported;
+    }
+    if (size.QuadPart == 0) {
+        // Empty files cannot be mapped; hand back an empty view instead.
+        CloseHandle(file);
+        return LB_Error_Ok;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return LB_Error_Unknown;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the section alive; the mapping handle is no longer needed.
+    CloseHandle(mapping);
+    if (!view) {
+        return LB_Error_OutOfMemory;
+    }
+
+    size_t byte_size = static_cast<size_t>(size.QuadPart);
+    if (hints & LB_MapHint_WillNeed) {
+        if (auto prefetch = resolve_prefetch_virtual_memory()) {
+            WIN32_MEMORY_RANGE_ENTRY range{view, byte_size};
+            prefetch(GetCurrentProcess(), 1, &range, 0);
+        }
+    }
+
+    out->data = static_cast<const uint8_t *>(view);
+    out->size = byte_size;
+    return LB_Error_Ok;
+}
+
+extern "C" void fs_unmap_file_impl(LB_MappedFile *file) {
+    if (!file) {
+        return;
+    }
+    if (file->data) {
+        UnmapViewOfFile(file->data);
+    }
+    file->data = nullptr;
+    file->size = 0;
+}
@@ -0,0 +1,421 @@
+#include <windows.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <objbase.h>
+
+#include "lb_platform.h"
+#include "win_fs_internal.h"
+#include "win_utf.h"
+
+extern "C" void post_task_impl(void (*fn)(void *), void *ctx);
+extern "C" LB_ErrorCode fs_read_entire_file_impl(const char *path_utf8, LB_FileResult *out);
+extern "C" LB_ErrorCode fs_write_file_ex_impl(const char *path_utf8, const void *data, size_t size, uint32_t flags);
+extern "C" LB_ErrorCode fs_stat_impl(const char *path_utf8, LB_FileStat *out);
+
+// Upper bound on worker threads servicing file requests.
+static const DWORD kFsPoolMaxThreads = 4;
+// Requests accepted but not yet delivered back to the event thread.
+static const size_t kFsMaxInFlight = 256;
+// Scratch read size used when warming files for fs_prefetch.
+static const DWORD kPrefetchChunkBytes = 1024 * 1024;
+// Prefetch runs on its own smaller pool so a long path list cannot starve read/write requests.
+static const DWORD kPrefetchPoolMaxThreads = 2;
+
+enum class FsRequestKind {
+    Read,
+    Write,
+    Stat
+};
+
+struct lb_fs_request {
+    FsRequestKind kind{};
+    std::atomic<bool> cancelled{false};
+    LB_FsAsyncCallback callback{};
+    void *callback_ctx{};
+    std::string path;
+    std::vector<uint8_t> data;
+    uint32_t write_flags{}; // LB_WriteFlags, writes only
+    LB_FsAsyncResult result{};
+};
+
+static std::once_flag g_pool_once;
+static PTP_POOL g_pool{nullptr};
+static TP_CALLBACK_ENVIRON g_pool_env;
+static std::atomic<size_t> g_in_flight{0};
+
+static PTP_CALLBACK_ENVIRON fs_pool_environment() {
+    std::call_once(g_pool_once, []() {
+        InitializeThreadpoolEnvironment(&g_pool_env);
+        g_pool = CreateThreadpool(nullptr);
+        if (!g_pool) {
+            // Fall back to the process-wide default pool.
+            lbw_log("lb_platform: CreateThreadpool failed for fs (err=%lu)", static_cast<unsigned long>(GetLastError()));
+            return;
+        }
+        SetThreadpoolThreadMaximum(g_pool, kFsPoolMaxThreads);
+        SetThreadpoolThreadMinimum(g_pool, 1);
+        SetThreadpoolCallbackPool(&g_pool_env, g_pool);
+    });
+    return &g_pool_env;
+}
+
+static std::once_flag g_prefetch_pool_once;
+static PTP_POOL g_prefetch_pool{nullptr};
+static TP_CALLBACK_ENVIRON g_prefetch_pool_env;
+
+static PTP_CALLBACK_ENVIRON prefetch_pool_environment() {
+    std::call_once(g_prefetch_pool_once, []() {
+        InitializeThreadpoolEnvironment(&g_prefetch_pool_env);
+        g_prefetch_pool = CreateThreadpool(nullptr);
+        if (!g_prefetch_pool) {
+            lbw_log("lb_platform: CreateThreadpool failed for prefetch (err=%lu)", static_cast<unsigned long>(GetLastError()));
+            return;
+        }
+        SetThreadpoolThreadMaximum(g_prefetch_pool, kPrefetchPoolMaxThreads);
+        SetThreadpoolThreadMinimum(g_prefetch_pool, 1);
+        SetThreadpoolCallbackPool(&g_prefetch_pool_env, g_prefetch_pool);
+    });
+    return &g_prefetch_pool_env;
+}
+
+static void deliver_fs_result(void *ctx) {
+    std::unique_ptr<lb_fs_request> req(static_cast<lb_fs_request *>(ctx));
+    if (!req) {
+        return;
+    }
+    if (!req->cancelled.load() && req->callback) {
+        req->callback(&req->result, req->callback_ctx);
+    } else if (req->result.buffer.data) {
+        CoTaskMemFree(req->result.buffer.data);
+    }
+    g_in_flight.fetch_sub(1);
+}
+
+static VOID CALLBACK fs_request_work(PTP_CALLBACK_INSTANCE, PVOID param) {
+    auto *req = static_cast<lb_fs_request *>(param);
+
+    if (req->cancelled.load()) {
+        req->result.error = LB_Error_Unknown;
+    } else {
+        switch (req->kind) {
+            case FsRequestKind::Read: {
+                LB_FileResult file{};
+                req->result.error = fs_read_entire_file_impl(req->path.c_str(), &file);
+                req->result.buffer = file.buffer;
+                break;
+            }
+            case FsRequestKind::Write:
+                req->result.error = fs_write_file_ex_impl(req->path.c_str(), req->data.data(), req->data.size(), req->write_flags);
+                req->data.clear();
+                req->data.shrink_to_fit();
+                break;
+            case FsRequestKind::Stat:
+                req->result.error = fs_stat_impl(req->path.c_str(), &req->result.stat);
+                break;
+        }
+    }
+
+    post_task_impl(&deliver_fs_result, req);
+}
+
+static bool reserve_in_flight() {
+    if (g_in_flight.fetch_add(1) >= kFsMaxInFlight) {
+        g_in_flight.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+static LB_ErrorCode submit_fs_request(std::unique_ptr<lb_fs_request> req, lb_fs_request **out_handle) {
+    if (!reserve_in_flight()) {
+        return LB_Error_Busy;
+    }
+
+    lb_fs_request *raw = req.get();
+    if (!TrySubmitThreadpoolCallback(&fs_request_work, raw, fs_pool_environment())) {
+        g_in_flight.fetch_sub(1);
+        return LB_Error_Unknown;
+    }
+    req.release();
+
+    if (out_handle) {
+        *out_handle = raw;
+    }
+    return LB_Error_Ok;
+}
+
+static std::unique_ptr<lb_fs_request> make_fs_request(FsRequestKind kind, const char *path_utf8, LB_FsAsyncCallback cb, void *ctx) {
+    std::unique_ptr<lb_fs_request> req(new lb_fs_request{});
+    req->kind = kind;
+    req->callback = cb;
+    req->callback_ctx = ctx;
+    req->path = path_utf8;
+    req->result.error = LB_Error_Unknown;
+    return req;
+}
+
+extern "C" LB_ErrorCode fs_read_async_impl(const char *path_utf8, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle) {
+    if (out_handle) {
+        *out_handle = nullptr;
+    }
+    if (!path_utf8 || !cb) {
+        return LB_Error_BadArgument;
+    }
+    return submit_fs_request(make_fs_request(FsRequestKind::Read, path_utf8, cb, ctx), out_handle);
+}
+
+// Group commit: a single cycle at a time takes every queued write, writes them all, then
+// flushes and publishes them. Writes arriving while a cycle is flushing wait for the next one,
+// so a burst of small writes shares a handful of flush cycles instead of one each.
+struct GroupCommitQueue {
+    std::mutex mutex;
+    std::vector<lb_fs_request *> pending;
+    bool running{false};
+};
+
+static GroupCommitQueue g_group_commit;
+
+struct StagedWrite {
+    lb_fs_request *req{};
+    std::wstring target;
+    std::wstring staged_path;
+    HANDLE file{INVALID_HANDLE_VALUE};
+};
+
+static void run_group_commit_cycle(std::vector<lb_fs_request *> &batch) {
+    // Only the last live write to a path in this cycle touches the disk; earlier ones report
+    // its result. Cancellation is sampled once so a cancel landing mid-cycle cannot leave a
+    // path without the write the others were folded into.
+    std::vector<bool> live(batch.size());
+    std::unordered_map<std::string, lb_fs_request *> latest;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        live[i] = !batch[i]->cancelled.load();
+        if (live[i]) {
+            latest[batch[i]->path] = batch[i];
+        }
+    }
+
+    std::vector<StagedWrite> staged;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        lb_fs_request *req = batch[i];
+        if (!live[i] || latest[req->path] != req) {
+            continue;
+        }
+        StagedWrite write;
+        write.req = req;
+        write.target = lbw_utf8_to_wide(req->path.c_str());
+        if (write.target.empty()) {
+            req->result.error = LB_Error_BadArgument;
+            continue;
+        }
+        write.file = lbw_fs_begin_write(write.target.c_str(), (req->write_flags & LB_WriteFlag_Atomic) != 0, write.staged_path);
+        if (write.file == INVALID_HANDLE_VALUE) {
+            req->result.error = LB_Error_Unknown;
+            continue;
+        }
+        if (!lbw_fs_write_all(write.file, req->data.data(), req->data.size())) {
+            lbw_fs_abort_write(write.file, write.staged_path);
+            req->result.error = LB_Error_Unknown;
+            continue;
+        }
+        req->data.clear();
+        req->data.shrink_to_fit();
+        staged.push_back(std::move(write));
+    }
+
+    // All data is handed to the file system before the first flush, so write-back of later
+    // files overlaps with the flushes of earlier ones.
+    for (StagedWrite &write : staged) {
+        write.req->result.error = lbw_fs_finish_write(write.file, write.target.c_str(), write.staged_path, true);
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        lb_fs_request *req = batch[i];
+        if (live[i] && latest[req->path] != req) {
+            req->result.error = latest[req->path]->result.error;
+        }
+        post_task_impl(&deliver_fs_result, req);
+    }
+}
+
+static VOID CALLBACK group_commit_work(PTP_CALLBACK_INSTANCE, PVOID) {
+    for (;;) {
+        std::vector<lb_fs_request *> batch;
+        {
+            std::lock_guard<std::mutex> lk(g_group_commit.mutex);
+            if (g_group_commit.pending.empty()) {
+                g_group_commit.running = false;
+                return;
+            }
+            batch.swap(g_group_commit.pending);
+        }
+        run_group_commit_cycle(batch);
+    }
+}
+
+static LB_ErrorCode submit_group_commit(std::unique_ptr<lb_fs_request> req, lb_fs_request **out_handle) {
+    if (!reserve_in_flight()) {
+        return LB_Error_Busy;
+    }
+
+    lb_fs_request *raw = req.get();
+    {
+        std::lock_guard<std::mutex> lk(g_group_commit.mutex);
+        g_group_commit.pending.push_back(raw);
+        if (!g_group_commit.running) {
+            if (!TrySubmitThreadpoolCallback(&group_commit_work, nullptr, fs_pool_environment())) {
+                g_group_commit.pending.pop_back();
+                g_in_flight.fetch_sub(1);
+                return LB_Error_Unknown;
+            }
+            g_group_commit.running = true;
+        }
+    }
+    req.release();
+
+    if (out_handle) {
+        *out_handle = raw;
+    }
+    return LB_Error_Ok;
+}
+
+extern "C" LB_ErrorCode fs_write_async_ex_impl(const char *path_utf8, const void *data, size_t size, uint32_t flags, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle) {
+    if (out_handle) {
+        *out_handle = nullptr;
+    }
+    if (!path_utf8 || !cb || (!data && size > 0)) {
+        return LB_Error_BadArgument;
+    }
+    auto req = make_fs_request(FsRequestKind::Write, path_utf8, cb, ctx);
+    req->write_flags = flags;
+    if (size > 0) {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        req->data.assign(bytes, bytes + size);
+    }
+    if (flags & LB_WriteFlag_GroupCommit) {
+        return submit_group_commit(std::move(req), out_handle);
+    }
+    return submit_fs_request(std::move(req), out_handle);
+}
+
+extern "C" LB_ErrorCode fs_write_async_impl(const char *path_utf8, const void *data, size_t size, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle) {
+    return fs_write_async_ex_impl(path_utf8, data, size, LB_WriteFlag_None, cb, ctx, out_handle);
+}
+
+extern "C" LB_ErrorCode fs_stat_async_impl(const char *path_utf8, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle) {
+    if (out_handle) {
+        *out_handle = nullptr;
+    }
+    if (!path_utf8 || !cb) {
+        return LB_Error_BadArgument;
+    }
+    return submit_fs_request(make_fs_request(FsRequestKind::Stat, path_utf8, cb, ctx), out_handle);
+}
+
+struct FsPrefetchBatch {
+    LB_FsPrefetchCallback callback{};
+    void *callback_ctx{};
+};
+
+struct FsPrefetchItem {
+    std::shared_ptr<FsPrefetchBatch> batch;
+    size_t index{};
+    std::string path;
+    LB_ErrorCode error{LB_Error_Unknown};
+};
+
+// Pulls the whole file through the system cache so later reads are served from memory.
+static LB_ErrorCode warm_file(const char *path_utf8) {
+    WideStackString path(path_utf8);
+    if (path.empty()) {
+        return LB_Error_BadArgument;
+    }
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return LB_Error_Unknown;
+    }
+
+    thread_local std::vector<uint8_t> scratch;
+    if (scratch.empty()) {
+        scratch.resize(kPrefetchChunkBytes);
+    }
+
+    LB_ErrorCode result = LB_Error_Ok;
+    for (;;) {
+        DWORD chunk = 0;
+        if (!ReadFile(file, scratch.data(), kPrefetchChunkBytes, &chunk, nullptr)) {
+            result = LB_Error_Unknown;
+            break;
+        }
+        if (chunk == 0) {
+            break;
+        }
+    }
+    CloseHandle(file);
+    return result;
+}
+
+static void deliver_prefetch_result(void *ctx) {
+    std::unique_ptr<FsPrefetchItem> item(static_cast<FsPrefetchItem *>(ctx));
+    if (item && item->batch->callback) {
+        item->batch->callback(item->index, item->error, item->batch->callback_ctx);
+    }
+}
+
+static VOID CALLBACK fs_prefetch_work(PTP_CALLBACK_INSTANCE, PVOID param) {
+    auto *item = static_cast<FsPrefetchItem *>(param);
+    // A plain low CPU priority; background mode would also demote the pages read here to the
+    // low-priority standby list, which is reclaimed first and defeats the warm-up.
+    HANDLE thread = GetCurrentThread();
+    int previous = GetThreadPriority(thread);
+    SetThreadPriority(thread, THREAD_PRIORITY_BELOW_NORMAL);
+    item->error = warm_file(item->path.c_str());
+    SetThreadPriority(thread, previous);
+    post_task_impl(&deliver_prefetch_result, item);
+}
+
+extern "C" LB_ErrorCode fs_prefetch_impl(const char *const *paths_utf8, size_t count, LB_FsPrefetchCallback cb, void *ctx) {
+    if (!paths_utf8 && count > 0) {
+        return LB_Error_BadArgument;
+    }
+
+    auto batch = std::make_shared<FsPrefetchBatch>();
+    batch->callback = cb;
+    batch->callback_ctx = ctx;
+
+    // Each file is warmed independently on the prefetch pool, so up to kPrefetchPoolMaxThreads
+    // files are read in parallel. Prefetches do not count against kFsMaxInFlight.
+    for (size_t i = 0; i < count; ++i) {
+        std::unique_ptr<FsPrefetchItem> item(new FsPrefetchItem{});
+        item->batch = batch;
+        item->index = i;
+        if (!paths_utf8[i]) {
+            item->error = LB_Error_BadArgument;
+            post_task_impl(&deliver_prefetch_result, item.release());
+            continue;
+        }
+        item->path = paths_utf8[i];
+        if (TrySubmitThreadpoolCallback(&fs_prefetch_work, item.get(), prefetch_pool_environment())) {
+            item.release();
+        } else {
+            item->error = LB_Error_Unknown;
+            post_task_impl(&deliver_prefetch_result, item.release());
+        }
+    }
+    return LB_Error_Ok;
+}
+
+extern "C" void fs_request_cancel_impl(lb_fs_request *handle) {
+    if (!handle) {
+        return;
+    }
+    // The request is always released by deliver_fs_result on the event thread; a request
+    // that has not started yet skips its I/O, one already running is discarded on delivery.
+    handle->cancelled.store(true);
+}
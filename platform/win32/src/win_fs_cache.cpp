@@ -0,0 +1,149 @@
+#include <windows.h>
+
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <objbase.h>
+
+#include "lb_platform.h"
+
+extern "C" LB_ErrorCode fs_read_entire_file_impl(const char *path_utf8, LB_FileResult *out);
+extern "C" LB_ErrorCode fs_stat_impl(const char *path_utf8, LB_FileStat *out);
+
+// File contents shared between the cache and every outstanding LB_CachedFile.
+struct CachedBlob {
+    LB_Buffer buffer{};
+
+    ~CachedBlob() {
+        if (buffer.data) {
+            CoTaskMemFree(buffer.data);
+        }
+    }
+};
+
+struct CacheEntry {
+    std::string path;
+    uint64_t size{};
+    uint64_t modified_timestamp{};
+    std::shared_ptr<CachedBlob> blob;
+};
+
+struct FileCache {
+    std::mutex mutex;
+    uint64_t capacity{}; // 0 = caching disabled
+    uint64_t bytes{};
+    std::list<CacheEntry> lru; // most recently used at the front
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> index;
+    LB_FileCacheStats stats{};
+};
+
+static FileCache g_cache;
+
+static void erase_entry(FileCache &cache, std::list<CacheEntry>::iterator it) {
+    cache.bytes -= it->blob->buffer.size;
+    cache.stats.bytes_cached = cache.bytes;
+    cache.index.erase(it->path);
+    cache.lru.erase(it);
+}
+
+static void evict_to_capacity(FileCache &cache) {
+    while (cache.bytes > cache.capacity && !cache.lru.empty()) {
+        erase_entry(cache, std::prev(cache.lru.end()));
+        ++cache.stats.evictions;
+    }
+}
+
+static void hand_out(const std::shared_ptr<CachedBlob> &blob, LB_CachedFile *out) {
+    out->data = blob->buffer.data;
+    out->size = blob->buffer.size;
+    out->ref = new std::shared_ptr<CachedBlob>(blob);
+}
+
+extern "C" void fs_cache_configure_impl(uint64_t capacity_bytes) {
+    std::lock_guard<std::mutex> lk(g_cache.mutex);
+    g_cache.capacity = capacity_bytes;
+    g_cache.stats.capacity = capacity_bytes;
+    evict_to_capacity(g_cache);
+}
+
+extern "C" LB_ErrorCode fs_cache_read_impl(const char *path_utf8, LB_CachedFile *out) {
+    if (!path_utf8 || !out) {
+        return LB_Error_BadArgument;
+    }
+    out->data = nullptr;
+    out->size = 0;
+    out->ref = nullptr;
+
+    // Entries are validated against the current size and last-write time on every lookup.
+    LB_FileStat stat{};
+    LB_ErrorCode rc = fs_stat_impl(path_utf8, &stat);
+    if (rc != LB_Error_Ok) {
+        return rc;
+    }
+
+    std::string key(path_utf8);
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        auto found = g_cache.index.find(key);
+        if (found != g_cache.index.end()) {
+            auto it = found->second;
+            if (it->size == stat.size && it->modified_timestamp == stat.modified_timestamp) {
+                g_cache.lru.splice(g_cache.lru.begin(), g_cache.lru, it);
+                ++g_cache.stats.hits;
+                hand_out(it->blob, out);
+                return LB_Error_Ok;
+            }
+            erase_entry(g_cache, it);
+            ++g_cache.stats.invalidations;
+        }
+        ++g_cache.stats.misses;
+    }
+
+    LB_FileResult file{};
+    rc = fs_read_entire_file_impl(path_utf8, &file);
+    if (rc != LB_Error_Ok) {
+        return rc;
+    }
+    auto blob = std::make_shared<CachedBlob>();
+    blob->buffer = file.buffer;
+
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        if (g_cache.capacity > 0 && blob->buffer.size <= g_cache.capacity) {
+            // Another thread may have loaded the same path meanwhile; the newer read wins.
+            auto found = g_cache.index.find(key);
+            if (found != g_cache.index.end()) {
+                erase_entry(g_cache, found->second);
+            }
+            g_cache.lru.push_front(CacheEntry{key, stat.size, stat.modified_timestamp, blob});
+            g_cache.index[key] = g_cache.lru.begin();
+            g_cache.bytes += blob->buffer.size;
+            g_cache.stats.bytes_cached = g_cache.bytes;
+            evict_to_capacity(g_cache);
+        }
+    }
+
+    hand_out(blob, out);
+    return LB_Error_Ok;
+}
+
+extern "C" void fs_cache_release_impl(LB_CachedFile *file) {
+    if (!file) {
+        return;
+    }
+    delete static_cast<std::shared_ptr<CachedBlob> *>(file->ref);
+    file->data = nullptr;
+    file->size = 0;
+    file->ref = nullptr;
+}
+
+extern "C" void fs_cache_get_stats_impl(LB_FileCacheStats *out) {
+    if (!out) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(g_cache.mutex);
+    *out = g_cache.stats;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <windows.h>
+
+#include <string>
+
+#include "lb_platform.h"
+
+// Staged whole-file writes shared by fs_write_file_ex and the async group-commit queue.
+//
+// lbw_fs_begin_write opens the target itself (truncating it) or, for atomic writes, a fresh
+// temporary file next to it whose path is returned in `staged_path`. lbw_fs_finish_write
+// optionally flushes, closes the handle and moves the staged file over the target;
+// lbw_fs_abort_write closes the handle and discards the staged file.
+HANDLE lbw_fs_begin_write(const wchar_t *target, bool atomic, std::wstring &staged_path);
+bool lbw_fs_write_all(HANDLE file, const void *data, size_t size);
+LB_ErrorCode lbw_fs_finish_write(HANDLE file, const wchar_t *target, const std::wstring &staged_path, bool flush);
+void lbw_fs_abort_write(HANDLE file, const std::wstring &staged_path);
+
+// Drops trailing separators from a directory path, keeping the one a root needs: "C:\" stays
+// as is because "C:" names the drive's current directory, and so do "\\server\share\" and
+// their "\\?\" forms.
+void lbw_fs_trim_trailing_separators(std::wstring &path);
@@ -0,0 +1,285 @@
+#include <windows.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lb_platform.h"
+#include "win_fs_internal.h"
+#include "win_utf.h"
+
+// Entries per batch handed to the walk callback.
+static const size_t kWalkBatchEntries = 256;
+// Batches workers may queue ahead of the consumer before they block.
+static const size_t kWalkMaxQueuedBatches = 64;
+static const uint32_t kWalkMaxThreads = 16;
+
+struct WalkDirectory {
+    std::wstring path;     // absolute, no trailing separator
+    std::string relative;  // UTF-8, relative to the walk root
+    uint32_t depth{};      // depth of this directory's children
+};
+
+// Packed batch in the LB_DirectoryListingEx layout, built on a worker.
+struct WalkBatch {
+    std::vector<LB_DirectoryEntry> entries;
+    std::string names;
+};
+
+struct WalkState {
+    LB_WalkOptions options{};
+
+    std::mutex mutex;
+    std::condition_variable work_cv;    // directories queued / walk finished
+    std::condition_variable result_cv;  // batches queued / workers exited
+    std::condition_variable space_cv;   // consumer drained batches
+
+    std::deque<WalkDirectory> directories;
+    std::deque<WalkBatch> batches;
+    size_t active_workers{};
+    size_t exited_workers{};
+    size_t worker_count{};
+    bool stop{};
+};
+
+static void push_batch(WalkState &state, WalkBatch &batch) {
+    if (batch.entries.empty()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lk(state.mutex);
+    state.space_cv.wait(lk, [&]() { return state.stop || state.batches.size() < kWalkMaxQueuedBatches; });
+    if (state.stop) {
+        batch = WalkBatch{};
+        return;
+    }
+    state.batches.push_back(std::move(batch));
+    batch = WalkBatch{};
+    state.result_cv.notify_one();
+}
+
+// Only a root such as "C:\\" keeps its trailing separator.
+static std::wstring walk_child_path(const std::wstring &directory, const wchar_t *name) {
+    wchar_t last = directory.back();
+    return last == L'\\' || last == L'/' ? directory + name : directory + L"\\" + name;
+}
+
+static void walk_scan_directory(WalkState &state, const WalkDirectory &dir) {
+    std::wstring pattern = walk_child_path(dir.path, L"*");
+    WIN32_FIND_DATAW data;
+    HANDLE hFind = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch,
+                                    nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    const LB_WalkOptions &opts = state.options;
+    bool descend = opts.max_depth == 0 || dir.depth < opts.max_depth;
+    std::vector<WalkDirectory> children;
+    WalkBatch batch;
+    std::string relative;
+
+    do {
+        if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0) {
+            continue;
+        }
+        if ((opts.flags & LB_Walk_SkipHidden) && (data.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN)) {
+            continue;
+        }
+
+        relative = dir.relative;
+        if (!relative.empty()) {
+            relative.push_back('\\');
+        }
+        size_t name_start = relative.size();
+        size_t wide_length = wcslen(data.cFileName);
+        relative.resize(name_start + lbw_wide_to_utf8_max(wide_length));
+        relative.resize(name_start + lbw_wide_to_utf8_into(data.cFileName, wide_length, relative.data() + name_start,
+                                                           relative.size() - name_start + 1));
+
+        ULARGE_INTEGER size{};
+        size.HighPart = data.nFileSizeHigh;
+        size.LowPart = data.nFileSizeLow;
+        ULARGE_INTEGER ft{};
+        ft.HighPart = data.ftLastWriteTime.dwHighDateTime;
+        ft.LowPart = data.ftLastWriteTime.dwLowDateTime;
+
+        LB_DirectoryEntry entry{};
+        entry.size = size.QuadPart;
+        entry.modified_timestamp = ft.QuadPart;
+        entry.attributes = data.dwFileAttributes;
+        entry.is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? 1 : 0;
+
+        if (opts.filter) {
+            LB_FileStat stat{};
+            stat.size = entry.size;
+            stat.modified_timestamp = entry.modified_timestamp;
+            stat.attributes = entry.attributes;
+            stat.is_directory = entry.is_directory;
+            if (!opts.filter(relative.c_str(), &stat, opts.filter_ctx)) {
+                continue;
+            }
+        }
+
+        if (entry.is_directory && descend) {
+            // Reparse points (junctions, symlinks) can form cycles; only follow them on request.
+            bool is_link = (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+            if (!is_link || (opts.flags & LB_Walk_FollowReparsePoints)) {
+                children.push_back(WalkDirectory{walk_child_path(dir.path, data.cFileName), relative, dir.depth + 1});
+            }
+        }
+
+        if (entry.is_directory && (opts.flags & LB_Walk_SkipDirectories)) {
+            continue;
+        }
+
+        entry.name_offset = batch.names.size();
+        entry.name_length = relative.size();
+        batch.names.append(relative.c_str(), relative.size() + 1);
+        batch.entries.push_back(entry);
+        if (batch.entries.size() >= kWalkBatchEntries) {
+            push_batch(state, batch);
+        }
+    } while (FindNextFileW(hFind, &data));
+
+    FindClose(hFind);
+    push_batch(state, batch);
+
+    if (!children.empty()) {
+        std::lock_guard<std::mutex> lk(state.mutex);
+        for (auto &child : children) {
+            state.directories.push_back(std::move(child));
+        }
+        state.work_cv.notify_all();
+    }
+}
+
+static VOID CALLBACK walk_worker(PTP_CALLBACK_INSTANCE, PVOID param, PTP_WORK) {
+    auto &state = *static_cast<WalkState *>(param);
+    for (;;) {
+        WalkDirectory dir;
+        {
+            std::unique_lock<std::mutex> lk(state.mutex);
+            state.work_cv.wait(lk, [&]() {
+                return state.stop || !state.directories.empty() || state.active_workers == 0;
+            });
+            if (state.stop || state.directories.empty()) {
+                // No queued work and nobody left to produce more: the walk is done.
+                state.work_cv.notify_all();
+                break;
+            }
+            dir = std::move(state.directories.front());
+            state.directories.pop_front();
+            ++state.active_workers;
+        }
+
+        walk_scan_directory(state, dir);
+
+        std::lock_guard<std::mutex> lk(state.mutex);
+        --state.active_workers;
+        if (state.active_workers == 0 && state.directories.empty()) {
+            state.work_cv.notify_all();
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(state.mutex);
+    ++state.exited_workers;
+    state.result_cv.notify_one();
+}
+
+static uint32_t default_walk_threads() {
+    DWORD cpus = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return std::clamp<uint32_t>(static_cast<uint32_t>(cpus), 1u, kWalkMaxThreads);
+}
+
+extern "C" LB_ErrorCode fs_walk_impl(const char *root_utf8, const LB_WalkOptions *options, LB_WalkBatchCallback cb, void *ctx) {
+    if (!root_utf8 || !cb) {
+        return LB_Error_BadArgument;
+    }
+    std::wstring root = lbw_utf8_to_wide(root_utf8);
+    if (root.empty()) {
+        return LB_Error_BadArgument;
+    }
+    lbw_fs_trim_trailing_separators(root);
+
+    DWORD root_attributes = GetFileAttributesW(root.c_str());
+    if (root_attributes == INVALID_FILE_ATTRIBUTES || !(root_attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        return LB_Error_Unknown;
+    }
+
+    WalkState state;
+    if (options) {
+        state.options = *options;
+    }
+    uint32_t threads = state.options.max_threads ? std::min<uint32_t>(state.options.max_threads, kWalkMaxThreads)
+                                                 : default_walk_threads();
+    state.directories.push_back(WalkDirectory{root, std::string(), 1});
+
+    PTP_POOL pool = CreateThreadpool(nullptr);
+    if (!pool) {
+        return LB_Error_Unknown;
+    }
+    SetThreadpoolThreadMaximum(pool, threads);
+    SetThreadpoolThreadMinimum(pool, 1);
+    TP_CALLBACK_ENVIRON env;
+    InitializeThreadpoolEnvironment(&env);
+    SetThreadpoolCallbackPool(&env, pool);
+
+    PTP_WORK work = CreateThreadpoolWork(&walk_worker, &state, &env);
+    if (!work) {
+        DestroyThreadpoolEnvironment(&env);
+        CloseThreadpool(pool);
+        return LB_Error_Unknown;
+    }
+    state.worker_count = threads;
+    for (uint32_t i = 0; i < threads; ++i) {
+        SubmitThreadpoolWork(work);
+    }
+
+    // Batches are delivered on the calling thread, one at a time.
+    for (;;) {
+        WalkBatch batch;
+        {
+            std::unique_lock<std::mutex> lk(state.mutex);
+            state.result_cv.wait(lk, [&]() {
+                return !state.batches.empty() || state.exited_workers == state.worker_count;
+            });
+            if (state.batches.empty()) {
+                break;
+            }
+            batch = std::move(state.batches.front());
+            state.batches.pop_front();
+            state.space_cv.notify_one();
+        }
+
+        size_t table_bytes = batch.entries.size() * sizeof(LB_DirectoryEntry);
+        std::vector<uint8_t> packed(table_bytes + batch.names.size());
+        for (auto &entry : batch.entries) {
+            entry.name_offset += table_bytes;
+        }
+        memcpy(packed.data(), batch.entries.data(), table_bytes);
+        memcpy(packed.data() + table_bytes, batch.names.data(), batch.names.size());
+
+        LB_DirectoryListingEx listing{};
+        listing.buffer.data = packed.data();
+        listing.buffer.size = packed.size();
+        listing.entries = reinterpret_cast<const LB_DirectoryEntry *>(packed.data());
+        listing.count = batch.entries.size();
+        if (cb(&listing, ctx) != 0) {
+            std::lock_guard<std::mutex> lk(state.mutex);
+            state.stop = true;
+            state.batches.clear();
+            state.work_cv.notify_all();
+            state.space_cv.notify_all();
+        }
+    }
+
+    WaitForThreadpoolWorkCallbacks(work, FALSE);
+    CloseThreadpoolWork(work);
+    DestroyThreadpoolEnvironment(&env);
+    CloseThreadpool(pool);
+    return LB_Error_Ok;
+}
@@ -0,0 +1,248 @@
+#include <windows.h>
+
+#include <atomic>
+#include <cwchar>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lb_platform.h"
+#include "win_fs_internal.h"
+#include "win_utf.h"
+
+extern "C" void post_task_impl(void (*fn)(void *), void *ctx);
+extern "C" void *timer_start_impl(unsigned ms, int repeat, void (*cb)(void *), void *ctx);
+
+// Changes arriving within this window are merged into a single callback.
+static const unsigned kWatchCoalesceMs = 50;
+static const DWORD kWatchBufferBytes = 64 * 1024;
+
+struct WatchState {
+    HANDLE directory{INVALID_HANDLE_VALUE};
+    PTP_IO io{nullptr};
+    OVERLAPPED overlapped{};
+    std::vector<DWORD> buffer; // DWORD-aligned as ReadDirectoryChangesW requires
+    BOOL recursive{};
+    std::wstring file_filter; // non-empty when watching a single file
+    LB_FsWatchCallback callback{};
+    void *callback_ctx{};
+    std::atomic<bool> closed{false};
+    // Serializes re-arming the read against unwatch so no read is issued after the cancel.
+    std::mutex arm_mutex;
+
+    std::mutex mutex;
+    std::unordered_map<std::wstring, uint32_t> pending;
+    bool flush_scheduled{};
+    std::weak_ptr<WatchState> self;
+};
+
+struct lb_fs_watch {
+    std::shared_ptr<WatchState> state;
+};
+
+static uint32_t change_flags_for_action(DWORD action) {
+    switch (action) {
+        case FILE_ACTION_ADDED: return LB_FsChange_Added;
+        case FILE_ACTION_REMOVED: return LB_FsChange_Removed;
+        case FILE_ACTION_MODIFIED: return LB_FsChange_Modified;
+        case FILE_ACTION_RENAMED_OLD_NAME:
+        case FILE_ACTION_RENAMED_NEW_NAME: return LB_FsChange_Renamed;
+        default: return LB_FsChange_Modified;
+    }
+}
+
+static void deliver_watch_changes(void *ctx) {
+    std::unique_ptr<std::shared_ptr<WatchState>> holder(static_cast<std::shared_ptr<WatchState> *>(ctx));
+    WatchState &state = **holder;
+
+    std::unordered_map<std::wstring, uint32_t> changes;
+    {
+        std::lock_guard<std::mutex> lk(state.mutex);
+        changes.swap(state.pending);
+        state.flush_scheduled = false;
+    }
+    if (changes.empty() || state.closed.load() || !state.callback) {
+        return;
+    }
+
+    std::vector<std::string> paths;
+    paths.reserve(changes.size());
+    std::vector<LB_FsChange> records;
+    records.reserve(changes.size());
+    for (const auto &entry : changes) {
+        paths.push_back(lbw_wide_to_utf8(entry.first.c_str(), entry.first.size()));
+        records.push_back(LB_FsChange{nullptr, entry.second});
+    }
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].path_utf8 = paths[i].c_str();
+    }
+    state.callback(records.data(), records.size(), state.callback_ctx);
+}
+
+static void watch_flush_timer(void *ctx) {
+    // Timer queue thread; hop over to the event thread for delivery.
+    post_task_impl(&deliver_watch_changes, ctx);
+}
+
+static void record_change(WatchState &state, std::wstring path, uint32_t flags) {
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lk(state.mutex);
+        state.pending[std::move(path)] |= flags;
+        if (!state.flush_scheduled) {
+            state.flush_scheduled = true;
+            schedule = true;
+        }
+    }
+    if (schedule) {
+        auto holder = std::make_unique<std::shared_ptr<WatchState>>(state.self.lock());
+        if (*holder && timer_start_impl(kWatchCoalesceMs, 0, &watch_flush_timer, holder.get())) {
+            holder.release();
+        } else if (*holder) {
+            post_task_impl(&deliver_watch_changes, holder.release());
+        }
+    }
+}
+
+static bool issue_watch_read(WatchState &state) {
+    static const DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+                                       FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                                       FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_ATTRIBUTES;
+    StartThreadpoolIo(state.io);
+    state.overlapped = OVERLAPPED{};
+    if (!ReadDirectoryChangesW(state.directory, state.buffer.data(),
+                               static_cast<DWORD>(state.buffer.size() * sizeof(DWORD)),
+                               state.recursive, kNotifyFilter, nullptr, &state.overlapped, nullptr)) {
+        CancelThreadpoolIo(state.io);
+        return false;
+    }
+    return true;
+}
+
+static VOID CALLBACK watch_io_completion(PTP_CALLBACK_INSTANCE, PVOID context, PVOID, ULONG result, ULONG_PTR bytes, PTP_IO) {
+    auto &state = *static_cast<WatchState *>(context);
+    if (state.closed.load() || result == ERROR_OPERATION_ABORTED) {
+        return;
+    }
+
+    if (result != NO_ERROR && result != ERROR_NOTIFY_ENUM_DIR) {
+        // The directory is gone or unreadable; re-arming would only fail the same way again.
+        lbw_log("lb_platform: fs_watch stopped (err=%lu)", static_cast<unsigned long>(result));
+        record_change(state, std::wstring(), LB_FsChange_Error);
+        return;
+    }
+    if (result == ERROR_NOTIFY_ENUM_DIR || bytes == 0) {
+        // The kernel buffer overflowed; tell the consumer to rescan.
+        record_change(state, std::wstring(), LB_FsChange_Overflow);
+    } else {
+        const uint8_t *cursor = reinterpret_cast<const uint8_t *>(state.buffer.data());
+        for (;;) {
+            auto *info = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(cursor);
+            std::wstring name(info->FileName, info->FileNameLength / sizeof(wchar_t));
+            if (state.file_filter.empty() || _wcsicmp(name.c_str(), state.file_filter.c_str()) == 0) {
+                record_change(state, std::move(name), change_flags_for_action(info->Action));
+            }
+            if (info->NextEntryOffset == 0) {
+                break;
+            }
+            cursor += info->NextEntryOffset;
+        }
+    }
+
+    bool failed = false;
+    DWORD error = 0;
+    {
+        std::lock_guard<std::mutex> lk(state.arm_mutex);
+        failed = !state.closed.load() && !issue_watch_read(state);
+        error = failed ? GetLastError() : 0;
+    }
+    if (failed) {
+        // Reported outside arm_mutex: delivery may wait on the event thread, which can be
+        // blocked on that mutex in fs_unwatch.
+        lbw_log("lb_platform: ReadDirectoryChangesW re-arm failed (err=%lu)", static_cast<unsigned long>(error));
+        record_change(state, std::wstring(), LB_FsChange_Error);
+    }
+}
+
+extern "C" LB_ErrorCode fs_watch_impl(const char *path_utf8, int recursive, LB_FsWatchCallback cb, void *ctx, lb_fs_watch **out_handle) {
+    if (out_handle) {
+        *out_handle = nullptr;
+    }
+    if (!path_utf8 || !cb || !out_handle) {
+        return LB_Error_BadArgument;
+    }
+    std::wstring path = lbw_utf8_to_wide(path_utf8);
+    if (path.empty()) {
+        return LB_Error_BadArgument;
+    }
+    lbw_fs_trim_trailing_separators(path);
+
+    DWORD attributes = GetFileAttributesW(path.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES) {
+        return LB_Error_Unknown;
+    }
+
+    auto state = std::make_shared<WatchState>();
+    state->self = state;
+    state->callback = cb;
+    state->callback_ctx = ctx;
+    state->recursive = recursive ? TRUE : FALSE;
+    state->buffer.resize(kWatchBufferBytes / sizeof(DWORD));
+
+    std::wstring directory = path;
+    if (!(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        // Single file: watch its parent directory and report only that name.
+        size_t slash = path.find_last_of(L"\\/");
+        if (slash == std::wstring::npos) {
+            directory = L".";
+            state->file_filter = path;
+        } else {
+            directory = path.substr(0, slash + 1);
+            lbw_fs_trim_trailing_separators(directory);
+            state->file_filter = path.substr(slash + 1);
+        }
+        state->recursive = FALSE;
+    }
+
+    state->directory = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                   OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (state->directory == INVALID_HANDLE_VALUE) {
+        return LB_Error_Unknown;
+    }
+
+    state->io = CreateThreadpoolIo(state->directory, &watch_io_completion, state.get(), nullptr);
+    if (!state->io) {
+        CloseHandle(state->directory);
+        return LB_Error_Unknown;
+    }
+
+    if (!issue_watch_read(*state)) {
+        CloseThreadpoolIo(state->io);
+        CloseHandle(state->directory);
+        return LB_Error_NotSupported;
+    }
+
+    *out_handle = new lb_fs_watch{std::move(state)};
+    return LB_Error_Ok;
+}
+
+extern "C" void fs_unwatch_impl(lb_fs_watch *handle) {
+    if (!handle) {
+        return;
+    }
+    std::unique_ptr<lb_fs_watch> watch(handle);
+    WatchState &state = *watch->state;
+    {
+        std::lock_guard<std::mutex> lk(state.arm_mutex);
+        state.closed.store(true);
+        CancelIoEx(state.directory, &state.overlapped);
+    }
+    WaitForThreadpoolIoCallbacks(state.io, FALSE);
+    CloseThreadpoolIo(state.io);
+    CloseHandle(state.directory);
+    state.directory = INVALID_HANDLE_VALUE;
+    // Flushes already queued hold their own reference and observe `closed`.
+}
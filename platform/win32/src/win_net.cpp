@@ -1,60 +1,359 @@
 #include <windows.h>
+#include <windns.h>
 #include <winhttp.h>
-#include <process.h>
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <cstdio>
 #include <cstring>
 #include <cwchar>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <objbase.h>
 
 #include "lb_platform.h"
+#include "win_net_internal.h"
+#include "win_utf.h"
 
 extern "C" void post_task_impl(void (*fn)(void *), void *ctx);
 
-static std::wstring utf8_to_wide(const char *s) {
-    if (!s) return {};
-    int len = MultiByteToWideChar(CP_UTF8, 0, s, -1, nullptr, 0);
-    if (len <= 0) return {};
-    std::wstring out(static_cast<size_t>(len - 1), L'\0');
-    if (len > 1) {
-        MultiByteToWideChar(CP_UTF8, 0, s, -1, out.data(), len);
-    }
-    return out;
-}
-
-static std::string wide_to_utf8(const wchar_t *s, size_t length = static_cast<size_t>(-1)) {
-    if (!s) return {};
-    int len = WideCharToMultiByte(CP_UTF8, 0, s, static_cast<int>(length), nullptr, 0, nullptr, nullptr);
-    if (len <= 0) return {};
-    std::string out(static_cast<size_t>(len), '\0');
-    WideCharToMultiByte(CP_UTF8, 0, s, static_cast<int>(length), out.data(), len, nullptr, nullptr);
-    if (length == static_cast<size_t>(-1) && !out.empty() && out.back() == '\0')
-        out.pop_back();
-    return out;
-}
+// Keep-alive sockets WinHTTP may hold open to a single server.
+static const DWORD kNetMaxConnectionsPerHost = 6;
+// Per-origin connect handles unused for this long are closed on the next acquire.
+static const ULONGLONG kNetOriginIdleTimeoutMs = 90 * 1000;
+// Per-request WinHTTP timeouts; a stalled send or receive fails after kNetIoTimeoutMs.
+static const int kNetConnectTimeoutMs = 60 * 1000;
+static const int kNetIoTimeoutMs = 30 * 1000;
+// Requests executing at once across all hosts; later ones wait in the scheduler queue.
+static const size_t kNetMaxActiveRequests = 16;
+// Requests executing at once against a single host:port.
+static const uint32_t kNetMaxActivePerHost = 6;
+// Upload chunk size for file, provider and oversized in-memory bodies.
+static const DWORD kNetUploadChunkBytes = 64 * 1024;
+// Starting body buffer when the server does not announce a Content-Length.
+static const size_t kNetInitialBodyBytes = 64 * 1024;
+// Largest buffer reserved up front from a declared Content-Length; bigger bodies grow as they arrive.
+static const size_t kNetMaxPresizedBodyBytes = 32 * 1024 * 1024;
+// Largest body chunk handed to a streaming consumer in one on_data call.
+static const DWORD kNetStreamChunkBytes = 64 * 1024;
+// Body bytes a streaming request may have queued on the event thread before reading pauses.
+static const size_t kNetStreamWindowBytes = 1024 * 1024;
+// Origins with timing histograms; the least used one is dropped to admit a new origin.
+static const size_t kNetTimingMaxOrigins = 256;
+// A prefetched lookup counts as a hit for requests within this window; it also deduplicates
+// repeated prefetches of the same host.
+static const ULONGLONG kNetDnsPrefetchTtlMs = 60 * 1000;
+static const size_t kNetDnsPrefetchMaxHosts = 256;
+// Roughly how long servers keep an idle connection open; warm connections not reused by then
+// are counted as expired.
+static const ULONGLONG kNetWarmConnectionTtlMs = 30 * 1000;
 
+// A request is reference counted: the transfer holds one reference from creation until it has
+// handed off its result, and every task posted to the event thread holds another. Cancel only
+// flags the request and aborts its I/O, so it never waits on a worker.
 struct lb_net_request {
+    std::atomic<uint32_t> refs{1};
     std::atomic<bool> cancelled{false};
-    std::atomic<bool> callback_scheduled{false};
-    std::atomic<bool> finalized{false};
     LB_NetResponseCallback callback{};
     void *callback_ctx{};
-    HANDLE completion_event{nullptr};
-    HANDLE thread_handle{nullptr};
+    // Held while copying a chunk out of a borrowed body; cancel takes it so the consumer's
+    // buffer is never read after cancel returns. Never held across WinHTTP or consumer calls.
+    std::mutex borrow_mutex;
     std::wstring host;
     std::wstring path_and_query;
     std::wstring method_w;
     INTERNET_PORT port{};
     bool secure{};
+    bool decoding{}; // WinHTTP decodes gzip/deflate bodies for this request
     std::vector<std::pair<std::wstring, std::wstring>> headers;
-    std::vector<uint8_t> body;
+    // Upload source: an in-memory body (owned copy or borrowed), a file, or a pull provider.
+    std::vector<uint8_t> body_storage;
+    const uint8_t *body_data{};
+    size_t body_size{};
+    bool borrowed_body{}; // body_data belongs to the consumer (LB_NetRequestFlag_BorrowBody)
+    std::wstring body_file;
+    LB_NetBodyProvider body_provider{};
+    void *body_provider_ctx{};
+    uint64_t body_length{}; // provider only; 0 = unknown, sent chunked
+
+    // HTTP cache participation (buffered GETs only).
+    bool cacheable{};
+    std::string url_utf8;
+    NetHeaderList request_headers_utf8;
+
+    // Coalescing of identical in-flight GETs: followers are never scheduled and receive a copy
+    // of the leader's response. `subscribers` counts live interest in the transfer, so the
+    // leader keeps going while any follower still wants the result.
+    std::string coalesce_key; // empty = not coalescable
+    lb_net_request *leader{}; // followers only, until the response is fanned out
+    std::vector<lb_net_request *> followers;
+    std::atomic<uint32_t> subscribers{1};
+
+    std::atomic<int32_t> priority{0}; // LB_NetPriority; queue moves happen under the scheduler mutex
+    uint64_t enqueued_us{};
+
+    // Phase timestamps, written by the worker running the transfer. Always collected for the
+    // per-origin histograms; LB_NetRequestFlag_Timing also hands them to the consumer.
+    bool report_timing{};
+    LB_NetTiming timing{};
+
+    bool preconnect{}; // internal warm-up round trip from net_preconnect; no consumer
+    NetTransferSink sink{}; // internal transfers from lbw_net_start_transfer; on_complete is set
+
+    bool streaming{};
+    LB_NetStreamCallbacks stream_callbacks{};
+    std::mutex stream_mutex;
+    std::condition_variable stream_space;
+    size_t stream_outstanding{}; // bytes posted to the event thread but not yet consumed
+};
+
+// One long-lived WinHTTP session shared by every request, so WinHTTP's keep-alive pool can hand
+// established TCP/TLS connections to later requests for the same server. Connect handles are
+// cached per origin and dropped once they have been idle for kNetOriginIdleTimeoutMs.
+struct NetOrigin {
+    HINTERNET connect{};
+    uint32_t active{};
+    ULONGLONG last_used{};
 };
 
+struct NetSession {
+    std::mutex mutex;
+    HINTERNET session{};
+    bool open_failed{false};
+    std::unordered_map<std::wstring, NetOrigin> origins; // keyed by "host:port"
+};
+
+static NetSession g_net;
+
+static std::wstring origin_key(const std::wstring &host, INTERNET_PORT port) {
+    return host + L":" + std::to_wstring(port);
+}
+
+static HINTERNET net_session_locked() {
+    if (!g_net.session && !g_net.open_failed) {
+        g_net.session = WinHttpOpen(L"LadybirdPlatform/1.0",
+                                    WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+                                    WINHTTP_NO_PROXY_NAME,
+                                    WINHTTP_NO_PROXY_BYPASS,
+                                    0);
+        if (!g_net.session) {
+            g_net.open_failed = true;
+            lbw_log("lb_platform: WinHttpOpen failed (err=%lu)", static_cast<unsigned long>(GetLastError()));
+            return nullptr;
+        }
+        DWORD max_conns = kNetMaxConnectionsPerHost;
+        WinHttpSetOption(g_net.session, WINHTTP_OPTION_MAX_CONNS_PER_SERVER, &max_conns, sizeof(max_conns));
+    }
+    return g_net.session;
+}
+
+static void sweep_idle_origins_locked(ULONGLONG now) {
+    for (auto it = g_net.origins.begin(); it != g_net.origins.end();) {
+        if (it->second.active == 0 && now - it->second.last_used >= kNetOriginIdleTimeoutMs) {
+            WinHttpCloseHandle(it->second.connect);
+            it = g_net.origins.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+static HINTERNET acquire_origin(const std::wstring &host, INTERNET_PORT port) {
+    std::lock_guard<std::mutex> lk(g_net.mutex);
+    HINTERNET session = net_session_locked();
+    if (!session) {
+        return nullptr;
+    }
+    ULONGLONG now = GetTickCount64();
+    sweep_idle_origins_locked(now);
+
+    NetOrigin &origin = g_net.origins[origin_key(host, port)];
+    if (!origin.connect) {
+        origin.connect = WinHttpConnect(session, host.c_str(), port, 0);
+        if (!origin.connect) {
+            g_net.origins.erase(origin_key(host, port));
+            return nullptr;
+        }
+    }
+    ++origin.active;
+    origin.last_used = now;
+    return origin.connect;
+}
+
+static void release_origin(const std::wstring &host, INTERNET_PORT port) {
+    std::lock_guard<std::mutex> lk(g_net.mutex);
+    auto it = g_net.origins.find(origin_key(host, port));
+    if (it == g_net.origins.end()) {
+        return;
+    }
+    --it->second.active;
+    it->second.last_used = GetTickCount64();
+}
+
+static uint64_t monotonic_us() {
+    static LARGE_INTEGER frequency = []() {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return f;
+    }();
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return static_cast<uint64_t>(now.QuadPart) / static_cast<uint64_t>(frequency.QuadPart) * 1000000ull +
+           static_cast<uint64_t>(now.QuadPart) % static_cast<uint64_t>(frequency.QuadPart) * 1000000ull /
+               static_cast<uint64_t>(frequency.QuadPart);
+}
+
+// Per-origin latency histograms for net_get_origin_timing, keyed like g_net.origins.
+struct NetTimingStats {
+    std::mutex mutex;
+    std::unordered_map<std::wstring, LB_NetOriginTiming> origins;
+};
+
+static NetTimingStats g_timing;
+
+static size_t timing_bucket(uint64_t duration_us) {
+    uint64_t ms = duration_us / 1000;
+    size_t bucket = 0;
+    while (ms > 0 && bucket + 1 < LB_NET_TIMING_BUCKETS) {
+        ms >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+static void record_phase(LB_NetOriginTiming &stats, LB_NetTimingPhase phase, uint64_t start_us, uint64_t end_us) {
+    if (start_us == 0 || end_us < start_us) {
+        return;
+    }
+    ++stats.histogram[phase][timing_bucket(end_us - start_us)];
+}
+
+static void record_origin_timing(const std::wstring &host, INTERNET_PORT port, const LB_NetTiming &timing) {
+    std::wstring key = origin_key(host, port);
+    std::lock_guard<std::mutex> lk(g_timing.mutex);
+    auto it = g_timing.origins.find(key);
+    if (it == g_timing.origins.end()) {
+        if (g_timing.origins.size() >= kNetTimingMaxOrigins) {
+            auto least_used = std::min_element(g_timing.origins.begin(), g_timing.origins.end(),
+                                               [](const auto &a, const auto &b) { return a.second.requests < b.second.requests; });
+            g_timing.origins.erase(least_used);
+        }
+        it = g_timing.origins.emplace(std::move(key), LB_NetOriginTiming{}).first;
+    }
+
+    LB_NetOriginTiming &stats = it->second;
+    ++stats.requests;
+    stats.reused_connections += timing.connection_reused;
+    stats.bytes_sent += timing.bytes_sent;
+    stats.bytes_received += timing.bytes_received;
+    record_phase(stats, LB_NetTimingPhase_Queue, timing.queued_us, timing.started_us);
+    record_phase(stats, LB_NetTimingPhase_Dns, timing.dns_start_us, timing.dns_end_us);
+    record_phase(stats, LB_NetTimingPhase_Connect, timing.connect_start_us, timing.connect_end_us);
+    record_phase(stats, LB_NetTimingPhase_Tls, timing.connect_end_us, timing.tls_end_us);
+    record_phase(stats, LB_NetTimingPhase_Wait, timing.request_start_us, timing.response_start_us);
+    record_phase(stats, LB_NetTimingPhase_Transfer, timing.response_start_us, timing.response_end_us);
+    record_phase(stats, LB_NetTimingPhase_Total, timing.queued_us, timing.response_end_us);
+}
+
+// Speculative warm-up state. Prefetched host names and warm connections are only bookkeeping:
+// the lookups land in the system resolver cache and the connections in WinHTTP's keep-alive
+// pool, and a request that later finds them is credited here.
+struct NetWarmup {
+    std::mutex mutex;
+    std::unordered_map<std::wstring, ULONGLONG> dns_prefetched; // host -> lookup finished (0 = pending)
+    std::unordered_map<std::wstring, std::deque<ULONGLONG>> warm_connections; // "host:port" -> opened at
+    LB_NetPreconnectStats stats{};
+};
+
+static NetWarmup g_warmup;
+
+static void expire_warm_connections_locked(std::deque<ULONGLONG> &opened, ULONGLONG now) {
+    while (!opened.empty() && now - opened.front() >= kNetWarmConnectionTtlMs) {
+        opened.pop_front();
+        ++g_warmup.stats.warm_connections_expired;
+    }
+}
+
+static void add_warm_connection(const std::wstring &host, INTERNET_PORT port) {
+    std::lock_guard<std::mutex> lk(g_warmup.mutex);
+    ULONGLONG now = GetTickCount64();
+    auto &opened = g_warmup.warm_connections[origin_key(host, port)];
+    expire_warm_connections_locked(opened, now);
+    opened.push_back(now);
+    ++g_warmup.stats.warm_connections;
+}
+
+// Called for consumer requests once the response has started. WinHTTP does not say which pooled
+// socket carried a request, so a reused connection is credited to the oldest unexpired warm one.
+static void claim_warmup(const std::wstring &host, INTERNET_PORT port, bool connection_reused) {
+    std::lock_guard<std::mutex> lk(g_warmup.mutex);
+    ULONGLONG now = GetTickCount64();
+    auto dns = g_warmup.dns_prefetched.find(host);
+    if (dns != g_warmup.dns_prefetched.end() && dns->second != 0) {
+        if (now - dns->second < kNetDnsPrefetchTtlMs) {
+            ++g_warmup.stats.dns_prefetch_hits;
+        }
+        g_warmup.dns_prefetched.erase(dns);
+    }
+
+    auto warm = g_warmup.warm_connections.find(origin_key(host, port));
+    if (warm == g_warmup.warm_connections.end()) {
+        return;
+    }
+    expire_warm_connections_locked(warm->second, now);
+    if (connection_reused && !warm->second.empty()) {
+        warm->second.pop_front();
+        ++g_warmup.stats.warm_connections_used;
+    }
+    if (warm->second.empty()) {
+        g_warmup.warm_connections.erase(warm);
+    }
+}
+
+// WinHTTP reports name resolution, connection setup and request start through the status
+// callback, also for synchronous handles; the context is the lb_net_request passed to
+// WinHttpSendRequest. It runs on the worker thread inside the blocking call.
+static void CALLBACK net_status_callback(HINTERNET, DWORD_PTR context, DWORD status, LPVOID, DWORD) {
+    auto *req = reinterpret_cast<lb_net_request *>(context);
+    if (!req) {
+        return;
+    }
+    LB_NetTiming &timing = req->timing;
+    uint64_t now = monotonic_us();
+    switch (status) {
+        case WINHTTP_CALLBACK_STATUS_RESOLVING_NAME:
+            timing.dns_start_us = now;
+            break;
+        case WINHTTP_CALLBACK_STATUS_NAME_RESOLVED:
+            timing.dns_end_us = now;
+            break;
+        case WINHTTP_CALLBACK_STATUS_CONNECTING_TO_SERVER:
+            timing.connect_start_us = now;
+            break;
+        case WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER:
+            timing.connect_end_us = now;
+            break;
+        case WINHTTP_CALLBACK_STATUS_SENDING_REQUEST:
+            if (timing.request_start_us == 0) {
+                timing.request_start_us = now;
+                if (req->secure && timing.connect_end_us != 0) {
+                    timing.tls_end_us = now;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
 struct NetResponsePayload {
     LB_NetResponse response{};
+    LB_NetTiming timing{};
     lb_net_request *request{};
 };
 
@@ -71,22 +370,10 @@ static void free_response_buffers(LB_NetResponse &resp) {
     }
 }
 
-static void finalize_request(lb_net_request *req) {
-    if (!req) return;
-    bool expected = false;
-    if (!req->finalized.compare_exchange_strong(expected, true)) {
-        return;
-    }
-    if (req->completion_event) {
-        WaitForSingleObject(req->completion_event, INFINITE);
-    }
-    if (req->thread_handle) {
-        CloseHandle(req->thread_handle);
-    }
-    if (req->completion_event) {
-        CloseHandle(req->completion_event);
+static void release_request(lb_net_request *req) {
+    if (req->refs.fetch_sub(1) == 1) {
+        delete req;
     }
-    delete req;
 }
 
 static void deliver_response(void *ctx) {
@@ -98,80 +385,758 @@ static void deliver_response(void *ctx) {
     lb_net_request *req = payload->request;
     if (!req->cancelled.load() && req->callback) {
         req->callback(&payload->response, req->callback_ctx);
+    } else {
+        free_response_buffers(payload->response);
     }
 
-    finalize_request(req);
+    release_request(req);
 }
 
-static unsigned __stdcall network_thread_proc(void *param) {
-    lb_net_request *req = static_cast<lb_net_request *>(param);
+static bool transfer_abandoned(lb_net_request *req) {
+    return req->subscribers.load() == 0;
+}
 
-    LB_NetResponse response{};
-    response.error = LB_Error_Unknown;
+// Hands the finished response to the event thread and drops the transfer's reference. The
+// request must not be touched afterwards.
+static void finish_request(lb_net_request *req, LB_NetResponse &response) {
+    if (!req->cancelled.load() && req->callback) {
+        std::unique_ptr<NetResponsePayload> payload(new NetResponsePayload{});
+        payload->response = response;
+        payload->request = req;
+        if (req->report_timing) {
+            payload->timing = req->timing;
+            payload->response.timing = &payload->timing;
+        }
+        req->refs.fetch_add(1);
+        post_task_impl(&deliver_response, payload.release());
+    } else {
+        free_response_buffers(response);
+    }
+    release_request(req);
+}
 
-    HINTERNET session = nullptr;
-    HINTERNET connect = nullptr;
-    HINTERNET request = nullptr;
+static HINTERNET open_request(lb_net_request *req, HINTERNET connect) {
+    const wchar_t *verb = req->method_w.empty() ? L"GET" : req->method_w.c_str();
+    DWORD open_flags = req->secure ? WINHTTP_FLAG_SECURE : 0;
+    HINTERNET request = WinHttpOpenRequest(connect,
+                                           verb,
+                                           req->path_and_query.c_str(),
+                                           nullptr,
+                                           WINHTTP_NO_REFERER,
+                                           WINHTTP_DEFAULT_ACCEPT_TYPES,
+                                           open_flags);
+    if (!request) {
+        return nullptr;
+    }
+    // A cancelled transfer unwinds when its blocked call returns, so these also bound how long an
+    // abandoned request can keep a worker busy.
+    WinHttpSetTimeouts(request, 0, kNetConnectTimeoutMs, kNetIoTimeoutMs, kNetIoTimeoutMs);
+    WinHttpSetStatusCallback(request, &net_status_callback,
+                             WINHTTP_CALLBACK_FLAG_RESOLVE_NAME | WINHTTP_CALLBACK_FLAG_CONNECT_TO_SERVER |
+                                 WINHTTP_CALLBACK_FLAG_SEND_REQUEST,
+                             0);
 
-    do {
-        session = WinHttpOpen(L"LadybirdPlatform/1.0",
-                              WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-                              WINHTTP_NO_PROXY_NAME,
-                              WINHTTP_NO_PROXY_BYPASS,
-                              0);
-        if (!session) {
-            break;
+    bool consumer_encoding = false;
+    for (const auto &hdr : req->headers) {
+        std::wstring header_line = hdr.first + L": " + hdr.second + L"\r\n";
+        WinHttpAddRequestHeaders(request, header_line.c_str(),
+                                 static_cast<DWORD>(header_line.size()),
+                                 WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
+        consumer_encoding = consumer_encoding || _wcsicmp(hdr.first.c_str(), L"Accept-Encoding") == 0;
+    }
+
+    // WinHTTP then advertises gzip and deflate and decodes them inside WinHttpReadData, so bodies
+    // are inflated chunk by chunk on this worker. Consumers sending their own Accept-Encoding get
+    // the bytes as sent, and internal transfers stay on the identity encoding so byte ranges
+    // line up with the file on disk.
+    if (!consumer_encoding && !req->sink.on_complete) {
+        DWORD decompression = WINHTTP_DECOMPRESSION_FLAG_GZIP | WINHTTP_DECOMPRESSION_FLAG_DEFLATE;
+        req->decoding = WinHttpSetOption(request, WINHTTP_OPTION_DECOMPRESSION, &decompression, sizeof(decompression));
+    }
+    return request;
+}
+
+// Once WinHTTP has decoded the body, Content-Encoding and Content-Length describe bytes the
+// consumer never sees.
+static void strip_decoded_headers(NetHeaderList &headers) {
+    const std::string *encoding = lbw_net_find_header(headers, "Content-Encoding");
+    if (!encoding || (_stricmp(encoding->c_str(), "gzip") != 0 && _stricmp(encoding->c_str(), "x-gzip") != 0 &&
+                      _stricmp(encoding->c_str(), "deflate") != 0)) {
+        return;
+    }
+    headers.erase(std::remove_if(headers.begin(), headers.end(),
+                                 [](const auto &header) {
+                                     return _stricmp(header.first.c_str(), "Content-Encoding") == 0 ||
+                                            _stricmp(header.first.c_str(), "Content-Length") == 0;
+                                 }),
+                  headers.end());
+}
+
+// True while the body is still in a content coding the consumer has to undo itself.
+static bool has_content_coding(const NetHeaderList &headers) {
+    const std::string *encoding = lbw_net_find_header(headers, "Content-Encoding");
+    return encoding && !encoding->empty() && _stricmp(encoding->c_str(), "identity") != 0;
+}
+
+static bool write_request_data(HINTERNET request, const uint8_t *data, size_t size) {
+    while (size > 0) {
+        DWORD to_write = size > MAXDWORD ? MAXDWORD : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WinHttpWriteData(request, data, to_write, &written)) {
+            return false;
         }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
 
-        connect = WinHttpConnect(session, req->host.c_str(), req->port, 0);
-        if (!connect) {
+// Sends a body that is not handed to WinHttpSendRequest in one piece: a file, a provider, or an
+// in-memory body too large for a DWORD. Sources are pulled kNetUploadChunkBytes at a time, so
+// peak memory stays at one chunk. Without a known length the body goes out chunked.
+static bool send_streamed_body(lb_net_request *req, HINTERNET request) {
+    HANDLE file = INVALID_HANDLE_VALUE;
+    uint64_t length = 0;
+    bool known_length = true;
+    if (!req->body_file.empty()) {
+        file = CreateFileW(req->body_file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size)) {
+            CloseHandle(file);
+            return false;
+        }
+        length = static_cast<uint64_t>(file_size.QuadPart);
+    } else if (req->body_provider) {
+        length = req->body_length;
+        known_length = length > 0;
+    } else {
+        length = req->body_size;
+    }
+
+    DWORD total_length = WINHTTP_IGNORE_REQUEST_TOTAL_LENGTH;
+    std::wstring extra_header;
+    if (!known_length) {
+        extra_header = L"Transfer-Encoding: chunked\r\n";
+    } else if (length > MAXDWORD) {
+        extra_header = L"Content-Length: " + std::to_wstring(length) + L"\r\n";
+    } else {
+        total_length = static_cast<DWORD>(length);
+    }
+    if (!extra_header.empty()) {
+        WinHttpAddRequestHeaders(request, extra_header.c_str(), static_cast<DWORD>(extra_header.size()),
+                                 WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
+    }
+
+    bool ok = WinHttpSendRequest(request, WINHTTP_NO_ADDITIONAL_HEADERS, 0, WINHTTP_NO_REQUEST_DATA, 0, total_length,
+                                 reinterpret_cast<DWORD_PTR>(req));
+    std::unique_ptr<uint8_t[]> chunk;
+    if (file != INVALID_HANDLE_VALUE || req->body_provider || req->borrowed_body) {
+        chunk.reset(new uint8_t[kNetUploadChunkBytes]);
+    }
+
+    uint64_t sent = 0;
+    while (ok) {
+        if (transfer_abandoned(req)) {
+            ok = false;
+            break;
+        }
+        const uint8_t *data = chunk.get();
+        size_t got = 0;
+        if (file != INVALID_HANDLE_VALUE) {
+            DWORD read = 0;
+            if (!ReadFile(file, chunk.get(), kNetUploadChunkBytes, &read, nullptr)) {
+                ok = false;
+                break;
+            }
+            got = read;
+        } else if (req->body_provider) {
+            // Cancel does not wait for the provider; whatever it returns after abandonment is
+            // dropped.
+            if (req->body_provider(chunk.get(), kNetUploadChunkBytes, &got, req->body_provider_ctx) != LB_Error_Ok ||
+                got > kNetUploadChunkBytes || transfer_abandoned(req)) {
+                ok = false;
+                break;
+            }
+        } else {
+            got = static_cast<size_t>(length - sent);
+            if (got > kNetUploadChunkBytes) {
+                got = kNetUploadChunkBytes;
+            }
+            if (req->borrowed_body) {
+                // WinHTTP only ever sees our copy, so a cancel can release the consumer's buffer
+                // while a write is still blocked.
+                std::lock_guard<std::mutex> lk(req->borrow_mutex);
+                if (transfer_abandoned(req)) {
+                    ok = false;
+                    break;
+                }
+                memcpy(chunk.get(), req->body_data + sent, got);
+            } else {
+                data = req->body_data + sent;
+            }
+        }
+        if (got == 0) {
+            break;
+        }
+        if (known_length && got > length - sent) {
+            ok = false;
             break;
         }
 
-        const wchar_t *verb = req->method_w.empty() ? L"GET" : req->method_w.c_str();
-        DWORD open_flags = req->secure ? WINHTTP_FLAG_SECURE : 0;
-        request = WinHttpOpenRequest(connect,
-                                     verb,
-                                     req->path_and_query.c_str(),
-                                     nullptr,
-                                     WINHTTP_NO_REFERER,
-                                     WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                     open_flags);
-        if (!request) {
+        if (known_length) {
+            ok = write_request_data(request, data, got);
+        } else {
+            char size_line[24];
+            int line_length = snprintf(size_line, sizeof(size_line), "%zx\r\n", got);
+            ok = write_request_data(request, reinterpret_cast<const uint8_t *>(size_line), static_cast<size_t>(line_length)) &&
+                 write_request_data(request, data, got) &&
+                 write_request_data(request, reinterpret_cast<const uint8_t *>("\r\n"), 2);
+        }
+        sent += got;
+    }
+
+    if (ok && !known_length) {
+        ok = write_request_data(request, reinterpret_cast<const uint8_t *>("0\r\n\r\n"), 5);
+    }
+    if (ok && known_length && sent != length) {
+        ok = false;
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    req->timing.bytes_sent = sent;
+    return ok;
+}
+
+static bool send_request(lb_net_request *req, HINTERNET request) {
+    if (transfer_abandoned(req)) {
+        return false;
+    }
+    if (!req->body_file.empty() || req->body_provider || req->borrowed_body || req->body_size > MAXDWORD) {
+        return send_streamed_body(req, request);
+    }
+
+    DWORD body_size = static_cast<DWORD>(req->body_size);
+    LPVOID body_ptr = body_size == 0 ? WINHTTP_NO_REQUEST_DATA : const_cast<uint8_t *>(req->body_data);
+
+    req->timing.bytes_sent = body_size;
+    return WinHttpSendRequest(request,
+                              WINHTTP_NO_ADDITIONAL_HEADERS,
+                              0,
+                              body_ptr,
+                              body_size,
+                              body_size,
+                              reinterpret_cast<DWORD_PTR>(req));
+}
+
+static NetHeaderList query_response_headers(HINTERNET request) {
+    NetHeaderList parsed_headers;
+    DWORD raw_size = 0;
+    if (WinHttpQueryHeaders(request,
+                            WINHTTP_QUERY_RAW_HEADERS_CRLF,
+                            WINHTTP_HEADER_NAME_BY_INDEX,
+                            nullptr,
+                            &raw_size,
+                            WINHTTP_NO_HEADER_INDEX) || GetLastError() != ERROR_INSUFFICIENT_BUFFER || raw_size == 0) {
+        return parsed_headers;
+    }
+    std::vector<wchar_t> raw(raw_size / sizeof(wchar_t));
+    if (!WinHttpQueryHeaders(request,
+                             WINHTTP_QUERY_RAW_HEADERS_CRLF,
+                             WINHTTP_HEADER_NAME_BY_INDEX,
+                             raw.data(),
+                             &raw_size,
+                             WINHTTP_NO_HEADER_INDEX)) {
+        return parsed_headers;
+    }
+    size_t char_count = raw_size / sizeof(wchar_t);
+    if (char_count == 0) {
+        return parsed_headers;
+    }
+    raw.resize(char_count);
+    const wchar_t *cursor = raw.data();
+    if (*cursor) {
+        cursor += wcslen(cursor) + 1; // skip status line
+    }
+    while (*cursor) {
+        const wchar_t *line = cursor;
+        cursor += wcslen(cursor) + 1;
+        const wchar_t *colon = wcschr(line, L':');
+        if (!colon) {
+            continue;
+        }
+        const wchar_t *value = colon + 1;
+        while (*value == L' ') ++value;
+        parsed_headers.emplace_back(lbw_wide_to_utf8(line, static_cast<size_t>(colon - line)),
+                                    lbw_wide_to_utf8(value));
+    }
+    return parsed_headers;
+}
+
+// Packs headers into one CoTaskMem block of UTF-8 LB_NetHeader pairs owned by the consumer.
+static LB_ErrorCode pack_response_headers(const NetHeaderList &parsed_headers, LB_NetResponse &response) {
+    if (parsed_headers.empty()) {
+        return LB_Error_Ok;
+    }
+
+    size_t count = parsed_headers.size();
+    size_t total_string_bytes = 0;
+    for (const auto &entry : parsed_headers) {
+        total_string_bytes += entry.first.size() + 1;
+        total_string_bytes += entry.second.size() + 1;
+    }
+    size_t alloc_size = sizeof(LB_NetHeader) * count + total_string_bytes;
+    uint8_t *header_mem = static_cast<uint8_t *>(CoTaskMemAlloc(alloc_size));
+    if (!header_mem) {
+        return LB_Error_OutOfMemory;
+    }
+    auto *header_array = reinterpret_cast<LB_NetHeader *>(header_mem);
+    char *string_block = reinterpret_cast<char *>(header_array + count);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto &entry = parsed_headers[i];
+        header_array[i].name = string_block + offset;
+        memcpy(string_block + offset, entry.first.c_str(), entry.first.size());
+        offset += entry.first.size();
+        string_block[offset++] = '\0';
+        header_array[i].value = string_block + offset;
+        memcpy(string_block + offset, entry.second.c_str(), entry.second.size());
+        offset += entry.second.size();
+        string_block[offset++] = '\0';
+    }
+    response.headers = header_array;
+    response.header_count = count;
+    return LB_Error_Ok;
+}
+
+static LB_ErrorCode response_from_cache(const NetCacheEntry &entry, LB_NetResponse &response) {
+    response.http_status = entry.status;
+    LB_ErrorCode rc = pack_response_headers(entry.headers, response);
+    if (rc != LB_Error_Ok || entry.body->empty()) {
+        return rc;
+    }
+    uint8_t *mem = static_cast<uint8_t *>(CoTaskMemAlloc(entry.body->size()));
+    if (!mem) {
+        return LB_Error_OutOfMemory;
+    }
+    memcpy(mem, entry.body->data(), entry.body->size());
+    response.body.data = mem;
+    response.body.size = entry.body->size();
+    return LB_Error_Ok;
+}
+
+struct NetCoalescer {
+    std::mutex mutex;
+    std::unordered_map<std::string, lb_net_request *> in_flight; // coalesce_key -> leader
+};
+
+static NetCoalescer g_coalescer;
+
+static void reprioritize_request(lb_net_request *req, int32_t priority);
+
+// Attaches `req` to an identical request already in flight; returns false if it must run itself.
+static bool join_in_flight(lb_net_request *req) {
+    if (req->coalesce_key.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(g_coalescer.mutex);
+    auto found = g_coalescer.in_flight.find(req->coalesce_key);
+    if (found == g_coalescer.in_flight.end()) {
+        g_coalescer.in_flight.emplace(req->coalesce_key, req);
+        return false;
+    }
+    lb_net_request *leader = found->second;
+    if (transfer_abandoned(leader)) {
+        // The leader is winding down after a cancel; start a fresh transfer instead.
+        found->second = req;
+        return false;
+    }
+    leader->followers.push_back(req);
+    leader->subscribers.fetch_add(1);
+    req->leader = leader;
+    if (req->priority > leader->priority) {
+        // The shared transfer inherits the most urgent subscriber's priority.
+        reprioritize_request(leader, req->priority);
+    }
+    return true;
+}
+
+// Detaches a follower that has not been served yet and drops the reference the leader held for
+// it; returns false once the response is on its way.
+static bool leave_in_flight(lb_net_request *req) {
+    std::lock_guard<std::mutex> lk(g_coalescer.mutex);
+    lb_net_request *leader = req->leader;
+    if (!leader) {
+        return false;
+    }
+    auto &followers = leader->followers;
+    for (auto it = followers.begin(); it != followers.end(); ++it) {
+        if (*it == req) {
+            followers.erase(it);
             break;
         }
+    }
+    // When this was the last subscriber the leader's worker sees the transfer abandoned at its
+    // next check and unwinds.
+    leader->subscribers.fetch_sub(1);
+    req->leader = nullptr;
+    release_request(req);
+    return true;
+}
+
+static std::vector<lb_net_request *> take_followers(lb_net_request *req) {
+    std::vector<lb_net_request *> followers;
+    if (req->coalesce_key.empty()) {
+        return followers;
+    }
+    std::lock_guard<std::mutex> lk(g_coalescer.mutex);
+    auto found = g_coalescer.in_flight.find(req->coalesce_key);
+    if (found != g_coalescer.in_flight.end() && found->second == req) {
+        g_coalescer.in_flight.erase(found);
+    }
+    followers.swap(req->followers);
+    for (lb_net_request *follower : followers) {
+        follower->leader = nullptr;
+    }
+    return followers;
+}
 
-        for (const auto &hdr : req->headers) {
-            std::wstring header_line = hdr.first + L": " + hdr.second + L"\r\n";
-            WinHttpAddRequestHeaders(request, header_line.c_str(),
-                                     static_cast<DWORD>(header_line.size()),
-                                     WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
+static void copy_response(const LB_NetResponse &source, LB_NetResponse &copy) {
+    copy = LB_NetResponse{};
+    copy.error = source.error;
+    copy.http_status = source.http_status;
+    NetHeaderList headers;
+    for (size_t i = 0; i < source.header_count; ++i) {
+        headers.emplace_back(source.headers[i].name, source.headers[i].value);
+    }
+    if (pack_response_headers(headers, copy) != LB_Error_Ok) {
+        copy.error = LB_Error_OutOfMemory;
+        return;
+    }
+    if (source.body.size > 0) {
+        copy.body.data = static_cast<uint8_t *>(CoTaskMemAlloc(source.body.size));
+        if (!copy.body.data) {
+            free_response_buffers(copy);
+            copy.error = LB_Error_OutOfMemory;
+            return;
         }
+        memcpy(copy.body.data, source.body.data, source.body.size);
+        copy.body.size = source.body.size;
+    }
+}
+
+// Fans a buffered response out to coalesced followers, then finishes the request itself. When
+// the leader was cancelled the last follower takes over its buffers instead of a copy.
+static void complete_request(lb_net_request *req, LB_NetResponse &response) {
+    std::vector<lb_net_request *> followers = take_followers(req);
+    for (size_t i = 0; i < followers.size(); ++i) {
+        LB_NetResponse copy{};
+        if (i + 1 == followers.size() && req->cancelled.load()) {
+            copy = response;
+            response.headers = nullptr;
+            response.header_count = 0;
+            response.body = LB_Buffer{};
+        } else {
+            copy_response(response, copy);
+        }
+        followers[i]->timing = req->timing;
+        finish_request(followers[i], copy);
+    }
+    finish_request(req, response);
+}
+
+static void add_request_header(HINTERNET request, const std::string &name, const std::string &value) {
+    std::wstring header_line = lbw_utf8_to_wide(name.c_str()) + L": " + lbw_utf8_to_wide(value.c_str()) + L"\r\n";
+    WinHttpAddRequestHeaders(request, header_line.c_str(),
+                             static_cast<DWORD>(header_line.size()),
+                             WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
+}
 
-        DWORD body_size = req->body.empty() ? 0 : static_cast<DWORD>(req->body.size());
-        LPVOID body_ptr = req->body.empty() ? WINHTTP_NO_REQUEST_DATA : req->body.data();
+// Reads the body straight into the CoTaskMem block handed to the consumer. The block is sized
+// from Content-Length when the server sends one (for a decoded body that is only the encoded size,
+// a lower bound), up to kNetMaxPresizedBodyBytes so a bogus length cannot commit memory before any
+// data arrives, and grown geometrically past that, so the only copies left are the occasional
+// realloc and the final shrink.
+static LB_ErrorCode read_buffered_body(lb_net_request *req, HINTERNET request, LB_NetResponse &response) {
+    size_t capacity = kNetInitialBodyBytes;
+    uint64_t content_length = 0;
+    DWORD length_size = sizeof(content_length);
+    bool known_length = WinHttpQueryHeaders(request,
+                                            WINHTTP_QUERY_CONTENT_LENGTH | WINHTTP_QUERY_FLAG_NUMBER64,
+                                            WINHTTP_HEADER_NAME_BY_INDEX,
+                                            &content_length,
+                                            &length_size,
+                                            WINHTTP_NO_HEADER_INDEX);
+    if (known_length) {
+        if (content_length == 0) {
+            return LB_Error_Ok;
+        }
+        capacity = static_cast<size_t>(std::min<uint64_t>(content_length, kNetMaxPresizedBodyBytes));
+    }
+
+    uint8_t *data = static_cast<uint8_t *>(CoTaskMemAlloc(capacity));
+    if (!data && known_length) {
+        // An implausible Content-Length should not fail the request outright.
+        capacity = kNetInitialBodyBytes;
+        data = static_cast<uint8_t *>(CoTaskMemAlloc(capacity));
+    }
+    if (!data) {
+        return LB_Error_OutOfMemory;
+    }
+
+    size_t size = 0;
+    for (;;) {
+        if (size == capacity) {
+            DWORD available = 0;
+            if (!WinHttpQueryDataAvailable(request, &available)) {
+                CoTaskMemFree(data);
+                return LB_Error_Unknown;
+            }
+            if (available == 0) {
+                break;
+            }
+            size_t new_capacity = capacity * 2;
+            if (new_capacity - size < available) {
+                new_capacity = size + available;
+            }
+            auto *grown = static_cast<uint8_t *>(CoTaskMemRealloc(data, new_capacity));
+            if (!grown) {
+                CoTaskMemFree(data);
+                return LB_Error_OutOfMemory;
+            }
+            data = grown;
+            capacity = new_capacity;
+        }
 
-        if (!WinHttpSendRequest(request,
-                                WINHTTP_NO_ADDITIONAL_HEADERS,
-                                0,
-                                body_ptr,
-                                body_size,
-                                body_size,
-                                0)) {
+        size_t room = capacity - size;
+        DWORD to_read = room > MAXDWORD ? MAXDWORD : static_cast<DWORD>(room);
+        DWORD read = 0;
+        if (!WinHttpReadData(request, data + size, to_read, &read)) {
+            CoTaskMemFree(data);
+            return LB_Error_Unknown;
+        }
+        if (read == 0) {
             break;
         }
+        size += read;
+        if (transfer_abandoned(req)) {
+            CoTaskMemFree(data);
+            return LB_Error_Unknown;
+        }
+    }
 
-        if (req->cancelled.load()) {
+    if (size == 0) {
+        CoTaskMemFree(data);
+        return LB_Error_Ok;
+    }
+    if (size < capacity) {
+        if (auto *trimmed = static_cast<uint8_t *>(CoTaskMemRealloc(data, size))) {
+            data = trimmed;
+        }
+    }
+    response.body.data = data;
+    response.body.size = size;
+    return LB_Error_Ok;
+}
+
+// Streaming delivery: the response head, then each body chunk, then completion are posted to
+// the event thread in order. At most kNetStreamWindowBytes of body may be posted but not yet
+// consumed; the worker stops reading from the socket until the event thread catches up.
+enum class NetStreamEventKind {
+    Response,
+    Data,
+    Complete
+};
+
+struct NetStreamEvent {
+    lb_net_request *request{};
+    NetStreamEventKind kind{};
+    LB_NetResponse response{};
+    LB_NetTiming timing{};
+    std::unique_ptr<uint8_t[]> data;
+    size_t size{};
+    LB_ErrorCode error{LB_Error_Ok};
+};
+
+static void deliver_stream_event(void *ctx) {
+    std::unique_ptr<NetStreamEvent> event(static_cast<NetStreamEvent *>(ctx));
+    lb_net_request *req = event->request;
+    const LB_NetStreamCallbacks &callbacks = req->stream_callbacks;
+    bool live = !req->cancelled.load();
+
+    switch (event->kind) {
+        case NetStreamEventKind::Response:
+            if (live && callbacks.on_response) {
+                callbacks.on_response(&event->response, req->callback_ctx);
+            } else {
+                free_response_buffers(event->response);
+            }
             break;
+        case NetStreamEventKind::Data:
+            if (live && callbacks.on_data) {
+                callbacks.on_data(event->data.get(), event->size, req->callback_ctx);
+            }
+            {
+                std::lock_guard<std::mutex> lk(req->stream_mutex);
+                req->stream_outstanding -= event->size;
+            }
+            req->stream_space.notify_one();
+            break;
+        case NetStreamEventKind::Complete:
+            if (live && callbacks.on_complete) {
+                callbacks.on_complete(event->error, req->callback_ctx);
+            }
+            break;
+    }
+    release_request(req);
+}
+
+static void post_stream_event(lb_net_request *req, std::unique_ptr<NetStreamEvent> event) {
+    event->request = req;
+    req->refs.fetch_add(1);
+    post_task_impl(&deliver_stream_event, event.release());
+}
+
+static LB_ErrorCode read_streamed_body(lb_net_request *req, HINTERNET request) {
+    DWORD available = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(req->stream_mutex);
+            req->stream_space.wait(lk, [&]() {
+                return req->stream_outstanding < kNetStreamWindowBytes || req->cancelled.load();
+            });
+        }
+        if (req->cancelled.load()) {
+            return LB_Error_Unknown;
+        }
+        if (!WinHttpQueryDataAvailable(request, &available)) {
+            return LB_Error_Unknown;
+        }
+        if (available == 0) {
+            return LB_Error_Ok;
+        }
+
+        DWORD to_read = available < kNetStreamChunkBytes ? available : kNetStreamChunkBytes;
+        std::unique_ptr<NetStreamEvent> event(new NetStreamEvent{});
+        event->kind = NetStreamEventKind::Data;
+        event->data.reset(new uint8_t[to_read]);
+        DWORD read = 0;
+        if (!WinHttpReadData(request, event->data.get(), to_read, &read)) {
+            return LB_Error_Unknown;
+        }
+        event->size = read;
+        req->timing.bytes_received += read;
+        {
+            std::lock_guard<std::mutex> lk(req->stream_mutex);
+            req->stream_outstanding += read;
+        }
+        post_stream_event(req, std::move(event));
+    }
+}
+
+// Posts the final streaming event unless the consumer has cancelled, then drops the transfer's
+// reference. The request must not be touched afterwards.
+static void complete_stream(lb_net_request *req, LB_ErrorCode error) {
+    if (!req->cancelled.load()) {
+        std::unique_ptr<NetStreamEvent> event(new NetStreamEvent{});
+        event->kind = NetStreamEventKind::Complete;
+        event->error = error;
+        post_stream_event(req, std::move(event));
+    }
+    release_request(req);
+}
+
+// Internal transfers hand each chunk to the sink on the worker, so only one chunk is ever held.
+static LB_ErrorCode read_sink_body(lb_net_request *req, HINTERNET request) {
+    std::unique_ptr<uint8_t[]> chunk(new uint8_t[kNetStreamChunkBytes]);
+    for (;;) {
+        DWORD read = 0;
+        if (!WinHttpReadData(request, chunk.get(), kNetStreamChunkBytes, &read)) {
+            return LB_Error_Unknown;
+        }
+        if (read == 0) {
+            return LB_Error_Ok;
         }
+        req->timing.bytes_received += read;
+        if (transfer_abandoned(req) || !req->sink.on_data(req->sink.ctx, chunk.get(), read)) {
+            return LB_Error_Unknown;
+        }
+    }
+}
+
+static void complete_sink(lb_net_request *req, LB_ErrorCode error) {
+    req->sink.on_complete(req->sink.ctx, error);
+    release_request(req);
+}
+
+static void run_network_request(lb_net_request *req) {
+    LB_NetResponse response{};
+    response.error = LB_Error_Unknown;
+
+    HINTERNET connect = nullptr;
+    HINTERNET request = nullptr;
+
+    std::shared_ptr<const NetCacheEntry> cached;
+    NetCacheLookup lookup = NetCacheLookup::Miss;
+    LB_NetTiming &timing = req->timing;
+    timing.started_us = monotonic_us();
 
-        if (!WinHttpReceiveResponse(request, nullptr)) {
+    do {
+        if (transfer_abandoned(req)) {
             break;
         }
+        if (req->cacheable) {
+            lookup = lbw_net_cache_lookup(req->url_utf8, req->request_headers_utf8, cached);
+            if (lookup == NetCacheLookup::Fresh) {
+                response.error = response_from_cache(*cached, response);
+                timing.from_cache = 1;
+                timing.response_start_us = monotonic_us();
+                timing.bytes_received = response.body.size;
+                break;
+            }
+        }
 
-        if (req->cancelled.load()) {
+        connect = acquire_origin(req->host, req->port);
+        if (!connect) {
+            break;
+        }
+        request = open_request(req, connect);
+        if (!request || transfer_abandoned(req)) {
+            break;
+        }
+        if (lookup == NetCacheLookup::Stale) {
+            NetHeaderList validators;
+            lbw_net_cache_add_validators(*cached, validators);
+            for (const auto &validator : validators) {
+                add_request_header(request, validator.first, validator.second);
+            }
+        }
+        uint64_t send_start_us = monotonic_us();
+        if (!send_request(req, request) || transfer_abandoned(req)) {
+            break;
+        }
+        timing.request_end_us = monotonic_us();
+        if (timing.request_start_us == 0) {
+            timing.request_start_us = send_start_us;
+        }
+        if (!WinHttpReceiveResponse(request, nullptr) || transfer_abandoned(req)) {
             break;
         }
+        timing.response_start_us = monotonic_us();
+        timing.connection_reused = timing.connect_start_us == 0;
+        if (req->preconnect) {
+            // HEAD has no body; closing the handle returns the connection to the pool.
+            if (!timing.connection_reused) {
+                add_warm_connection(req->host, req->port);
+            }
+            response.error = LB_Error_Ok;
+            break;
+        }
+        claim_warmup(req->host, req->port, timing.connection_reused != 0);
 
         DWORD status = 0;
         DWORD status_size = sizeof(status);
@@ -184,159 +1149,233 @@ static unsigned __stdcall network_thread_proc(void *param) {
             response.http_status = status;
         }
 
-        std::vector<uint8_t> body_storage;
-        DWORD available = 0;
-        while (WinHttpQueryDataAvailable(request, &available)) {
-            if (available == 0) {
-                break;
-            }
-            size_t old_size = body_storage.size();
-            body_storage.resize(old_size + available);
-            DWORD read = 0;
-            if (!WinHttpReadData(request, body_storage.data() + old_size, available, &read)) {
-                body_storage.resize(old_size);
-                break;
-            }
-            body_storage.resize(old_size + read);
-            if (req->cancelled.load()) {
+        NetHeaderList response_headers = query_response_headers(request);
+        if (req->decoding) {
+            strip_decoded_headers(response_headers);
+        }
+        if (lookup == NetCacheLookup::Stale) {
+            if (status == 304) {
+                cached = lbw_net_cache_revalidated(cached, response_headers);
+                response.error = response_from_cache(*cached, response);
+                timing.bytes_received = response.body.size;
                 break;
             }
+            lbw_net_cache_count_miss();
         }
 
-        if (req->cancelled.load()) {
-            body_storage.clear();
+        if (req->sink.on_complete) {
+            response.error = req->sink.on_response(req->sink.ctx, status, response_headers)
+                                 ? read_sink_body(req, request)
+                                 : LB_Error_Unknown;
+            break;
         }
 
-        if (!body_storage.empty()) {
-            uint8_t *mem = static_cast<uint8_t *>(CoTaskMemAlloc(body_storage.size()));
-            if (!mem) {
-                response.error = LB_Error_OutOfMemory;
-                break;
+        response.error = pack_response_headers(response_headers, response);
+        if (response.error != LB_Error_Ok) {
+            break;
+        }
+
+        if (req->streaming) {
+            std::unique_ptr<NetStreamEvent> head(new NetStreamEvent{});
+            head->kind = NetStreamEventKind::Response;
+            head->response = response;
+            if (req->report_timing) {
+                head->timing = timing;
+                head->response.timing = &head->timing;
             }
-            memcpy(mem, body_storage.data(), body_storage.size());
-            response.body.data = mem;
-            response.body.size = body_storage.size();
-            response.error = LB_Error_Ok;
+            post_stream_event(req, std::move(head));
+            response = LB_NetResponse{};
+            response.error = read_streamed_body(req, request);
         } else {
-            response.body.data = nullptr;
-            response.body.size = 0;
-            response.error = req->cancelled.load() ? LB_Error_Unknown : LB_Error_Ok;
-        }
-
-        // Parse raw headers into UTF-8 pairs
-        if (response.error == LB_Error_Ok) {
-            DWORD raw_size = 0;
-            if (!WinHttpQueryHeaders(request,
-                                     WINHTTP_QUERY_RAW_HEADERS_CRLF,
-                                     WINHTTP_HEADER_NAME_BY_INDEX,
-                                     nullptr,
-                                     &raw_size,
-                                     WINHTTP_NO_HEADER_INDEX) && GetLastError() == ERROR_INSUFFICIENT_BUFFER && raw_size > 0) {
-                std::vector<wchar_t> raw(raw_size / sizeof(wchar_t));
-                if (WinHttpQueryHeaders(request,
-                                         WINHTTP_QUERY_RAW_HEADERS_CRLF,
-                                         WINHTTP_HEADER_NAME_BY_INDEX,
-                                         raw.data(),
-                                         &raw_size,
-                                         WINHTTP_NO_HEADER_INDEX)) {
-                    size_t char_count = raw_size / sizeof(wchar_t);
-                    if (char_count > 0) {
-                        raw.resize(char_count);
-                        const wchar_t *cursor = raw.data();
-                        if (*cursor) {
-                            cursor += wcslen(cursor) + 1; // skip status line
-                        }
-                        std::vector<std::pair<std::string, std::string>> parsed_headers;
-                        while (*cursor) {
-                            const wchar_t *line = cursor;
-                            cursor += wcslen(cursor) + 1;
-                            const wchar_t *colon = wcschr(line, L':');
-                            if (!colon) {
-                                continue;
-                            }
-                            const wchar_t *value = colon + 1;
-                            while (*value == L' ') ++value;
-                            std::wstring name_w(line, colon - line);
-                            std::wstring value_w(value);
-                            parsed_headers.emplace_back(wide_to_utf8(name_w.c_str(), name_w.size()),
-                                                         wide_to_utf8(value_w.c_str(), value_w.size()));
-                        }
-
-                        if (!parsed_headers.empty()) {
-                            size_t count = parsed_headers.size();
-                            size_t total_string_bytes = 0;
-                            for (const auto &entry : parsed_headers) {
-                                total_string_bytes += entry.first.size() + 1;
-                                total_string_bytes += entry.second.size() + 1;
-                            }
-                            size_t alloc_size = sizeof(LB_NetHeader) * count + total_string_bytes;
-                            uint8_t *header_mem = static_cast<uint8_t *>(CoTaskMemAlloc(alloc_size));
-                            if (header_mem) {
-                                auto *header_array = reinterpret_cast<LB_NetHeader *>(header_mem);
-                                char *string_block = reinterpret_cast<char *>(header_array + count);
-                                size_t offset = 0;
-                                for (size_t i = 0; i < count; ++i) {
-                                    const auto &entry = parsed_headers[i];
-                                    header_array[i].name = string_block + offset;
-                                    memcpy(string_block + offset, entry.first.c_str(), entry.first.size());
-                                    offset += entry.first.size();
-                                    string_block[offset++] = '\0';
-                                    header_array[i].value = string_block + offset;
-                                    memcpy(string_block + offset, entry.second.c_str(), entry.second.size());
-                                    offset += entry.second.size();
-                                    string_block[offset++] = '\0';
-                                }
-                                response.headers = header_array;
-                                response.header_count = count;
-                            } else {
-                                response.error = LB_Error_OutOfMemory;
-                                break;
-                            }
-                        }
-                    }
-                }
+            response.error = read_buffered_body(req, request, response);
+            timing.bytes_received = response.body.size;
+            // The cache key ignores Accept-Encoding, so only decoded bodies are stored; a body
+            // left encoded for one consumer must not reach another that relies on decoding.
+            if (response.error == LB_Error_Ok && req->cacheable && !transfer_abandoned(req) &&
+                !has_content_coding(response_headers)) {
+                lbw_net_cache_store(req->url_utf8, req->request_headers_utf8, status, response_headers,
+                                    response.body.data, response.body.size);
             }
         }
-
     } while (false);
 
     if (request) {
         WinHttpCloseHandle(request);
     }
     if (connect) {
-        WinHttpCloseHandle(connect);
+        release_origin(req->host, req->port);
     }
-    if (session) {
-        WinHttpCloseHandle(session);
+
+    if (response.error == LB_Error_Ok && timing.response_start_us != 0) {
+        timing.response_end_us = monotonic_us();
+        if (!timing.from_cache && !req->preconnect && !transfer_abandoned(req)) {
+            record_origin_timing(req->host, req->port, timing);
+        }
     }
 
-    if (req->cancelled.load() || !req->callback) {
-        free_response_buffers(response);
+    if (req->sink.on_complete) {
+        complete_sink(req, response.error);
+    } else if (req->streaming) {
+        complete_stream(req, response.error);
+    } else {
+        complete_request(req, response);
     }
+}
+
+// Requests run on a private thread pool instead of a dedicated thread each. Queued requests
+// are dispatched highest priority first, FIFO within a priority, skipping requests whose host
+// already has kNetMaxActivePerHost running so one busy origin cannot starve the others.
+struct NetScheduler {
+    std::mutex mutex;
+    std::deque<lb_net_request *> pending[LB_NET_PRIORITY_LEVELS]; // index 0 = LB_NetPriority_Lowest
+    std::unordered_map<std::wstring, uint32_t> active_per_host;
+    size_t active{};
+    LB_NetSchedulerStats stats{};
+};
 
-    SetEvent(req->completion_event);
+static NetScheduler g_scheduler;
+static std::once_flag g_net_pool_once;
+static PTP_POOL g_net_pool{nullptr};
+static TP_CALLBACK_ENVIRON g_net_pool_env;
 
-    if (!req->cancelled.load() && req->callback) {
-        std::unique_ptr<NetResponsePayload> payload(new NetResponsePayload{});
-        payload->response = response;
-        payload->request = req;
-        req->callback_scheduled.store(true);
-        post_task_impl(&deliver_response, payload.release());
-    } else {
-        finalize_request(req);
+static PTP_CALLBACK_ENVIRON net_pool_environment() {
+    std::call_once(g_net_pool_once, []() {
+        InitializeThreadpoolEnvironment(&g_net_pool_env);
+        g_net_pool = CreateThreadpool(nullptr);
+        if (!g_net_pool) {
+            // Fall back to the process-wide default pool.
+            lbw_log("lb_platform: CreateThreadpool failed for net (err=%lu)", static_cast<unsigned long>(GetLastError()));
+            return;
+        }
+        SetThreadpoolThreadMaximum(g_net_pool, static_cast<DWORD>(kNetMaxActiveRequests));
+        SetThreadpoolThreadMinimum(g_net_pool, 1);
+        SetThreadpoolCallbackPool(&g_net_pool_env, g_net_pool);
+    });
+    return &g_net_pool_env;
+}
+
+static size_t priority_level(int32_t priority) {
+    int32_t clamped = std::clamp<int32_t>(priority, LB_NetPriority_Lowest, LB_NetPriority_Highest);
+    return static_cast<size_t>(clamped - LB_NetPriority_Lowest);
+}
+
+static void pump_scheduler();
+
+static VOID CALLBACK net_request_work(PTP_CALLBACK_INSTANCE, PVOID param) {
+    auto *req = static_cast<lb_net_request *>(param);
+    std::wstring origin = origin_key(req->host, req->port);
+    run_network_request(req);
+    {
+        std::lock_guard<std::mutex> lk(g_scheduler.mutex);
+        --g_scheduler.active;
+        auto it = g_scheduler.active_per_host.find(origin);
+        if (it != g_scheduler.active_per_host.end() && --it->second == 0) {
+            g_scheduler.active_per_host.erase(it);
+        }
+        g_scheduler.stats.active = static_cast<uint32_t>(g_scheduler.active);
     }
+    pump_scheduler();
+}
 
-    return 0;
+// Picks the next dispatchable request, or nullptr if every queued request is blocked.
+static lb_net_request *take_next_locked(size_t &level_out) {
+    for (size_t level = LB_NET_PRIORITY_LEVELS; level-- > 0;) {
+        auto &queue = g_scheduler.pending[level];
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            auto host = g_scheduler.active_per_host.find(origin_key((*it)->host, (*it)->port));
+            if (host != g_scheduler.active_per_host.end() && host->second >= kNetMaxActivePerHost) {
+                continue;
+            }
+            lb_net_request *req = *it;
+            queue.erase(it);
+            level_out = level;
+            return req;
+        }
+    }
+    return nullptr;
 }
-extern "C" LB_ErrorCode net_request_impl(const LB_NetRequestDesc *desc, LB_NetResponseCallback cb, void *ctx, lb_net_request **out_handle) {
-    if (out_handle) {
-        *out_handle = nullptr;
+
+static void pump_scheduler() {
+    std::vector<lb_net_request *> failed;
+    {
+        std::lock_guard<std::mutex> lk(g_scheduler.mutex);
+        while (g_scheduler.active < kNetMaxActiveRequests) {
+            size_t level = 0;
+            lb_net_request *req = take_next_locked(level);
+            if (!req) {
+                break;
+            }
+            --g_scheduler.stats.queued;
+            if (!TrySubmitThreadpoolCallback(&net_request_work, req, net_pool_environment())) {
+                failed.push_back(req);
+                continue;
+            }
+            ++g_scheduler.active;
+            ++g_scheduler.active_per_host[origin_key(req->host, req->port)];
+            uint64_t waited = monotonic_us() - req->enqueued_us;
+            ++g_scheduler.stats.dispatched[level];
+            g_scheduler.stats.total_queue_us[level] += waited;
+            g_scheduler.stats.max_queue_us[level] = std::max<uint64_t>(g_scheduler.stats.max_queue_us[level], waited);
+        }
+        g_scheduler.stats.active = static_cast<uint32_t>(g_scheduler.active);
+    }
+    for (lb_net_request *req : failed) {
+        if (req->sink.on_complete) {
+            complete_sink(req, LB_Error_Unknown);
+        } else if (req->streaming) {
+            complete_stream(req, LB_Error_Unknown);
+        } else {
+            LB_NetResponse response{};
+            response.error = LB_Error_Unknown;
+            complete_request(req, response);
+        }
+    }
+}
+
+static bool remove_pending_locked(lb_net_request *req) {
+    auto &queue = g_scheduler.pending[priority_level(req->priority)];
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        if (*it == req) {
+            queue.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Removes a request that has not started yet; returns false once a worker owns it.
+static bool unschedule_request(lb_net_request *req) {
+    std::lock_guard<std::mutex> lk(g_scheduler.mutex);
+    if (!remove_pending_locked(req)) {
+        return false;
     }
-    if (!desc || !desc->url_utf8 || !cb) {
+    --g_scheduler.stats.queued;
+    return true;
+}
+
+// Moves a queued request to another priority; running requests just record the new value.
+static void reprioritize_request(lb_net_request *req, int32_t priority) {
+    std::lock_guard<std::mutex> lk(g_scheduler.mutex);
+    if (priority_level(priority) == priority_level(req->priority)) {
+        req->priority = priority;
+        return;
+    }
+    bool queued = remove_pending_locked(req);
+    req->priority = priority;
+    if (queued) {
+        // Queued requests are blocked on a global or per-host limit, which a new position does
+        // not lift, so there is nothing to pump here.
+        g_scheduler.pending[priority_level(priority)].push_back(req);
+    }
+}
+
+static LB_ErrorCode create_request(const LB_NetRequestDesc *desc, lb_net_request **out) {
+    *out = nullptr;
+    if (!desc || !desc->url_utf8) {
         return LB_Error_BadArgument;
     }
 
-    std::wstring url_w = utf8_to_wide(desc->url_utf8);
+    std::wstring url_w = lbw_utf8_to_wide(desc->url_utf8);
     if (url_w.empty()) {
         return LB_Error_BadArgument;
     }
@@ -357,13 +1396,8 @@ extern "C" LB_ErrorCode net_request_impl(const LB_NetRequestDesc *desc, LB_NetRe
     }
 
     auto *req = new lb_net_request{};
-    req->callback = cb;
-    req->callback_ctx = ctx;
-    req->completion_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
-    if (!req->completion_event) {
-        delete req;
-        return LB_Error_Unknown;
-    }
+    req->priority = desc->priority;
+    req->report_timing = (desc->flags & LB_NetRequestFlag_Timing) != 0;
 
     req->host.assign(components.lpszHostName, components.dwHostNameLength);
     std::wstring path_part(components.lpszUrlPath, components.dwUrlPathLength);
@@ -377,7 +1411,7 @@ extern "C" LB_ErrorCode net_request_impl(const LB_NetRequestDesc *desc, LB_NetRe
     req->secure = (components.nScheme == INTERNET_SCHEME_HTTPS);
 
     if (desc->method == LB_NetMethod_Custom && desc->custom_method) {
-        req->method_w = utf8_to_wide(desc->custom_method);
+        req->method_w = lbw_utf8_to_wide(desc->custom_method);
     } else {
         switch (desc->method) {
             case LB_NetMethod_Post: req->method_w = L"POST"; break;
@@ -390,30 +1424,95 @@ extern "C" LB_ErrorCode net_request_impl(const LB_NetRequestDesc *desc, LB_NetRe
 
     if (desc->headers && desc->header_count > 0) {
         for (size_t i = 0; i < desc->header_count; ++i) {
-            std::wstring name_w = utf8_to_wide(desc->headers[i].name);
-            std::wstring value_w = utf8_to_wide(desc->headers[i].value);
+            std::wstring name_w = lbw_utf8_to_wide(desc->headers[i].name);
+            std::wstring value_w = lbw_utf8_to_wide(desc->headers[i].value);
             req->headers.emplace_back(std::move(name_w), std::move(value_w));
         }
     }
 
-    if (desc->body && desc->body_size > 0) {
-        req->body.assign(desc->body, desc->body + desc->body_size);
+    // Plain GETs go through the HTTP cache unless the consumer manages validation or ranges
+    // itself.
+    req->cacheable = req->method_w == L"GET" && !(desc->flags & LB_NetRequestFlag_NoCache) &&
+                     !desc->body_provider && !desc->body_file_utf8 && desc->body_size == 0 &&
+                     lbw_net_cache_enabled();
+    if (req->cacheable) {
+        req->url_utf8 = desc->url_utf8;
+        for (size_t i = 0; desc->headers && i < desc->header_count; ++i) {
+            req->request_headers_utf8.emplace_back(desc->headers[i].name ? desc->headers[i].name : "",
+                                                   desc->headers[i].value ? desc->headers[i].value : "");
+        }
+        for (const char *name : {"If-None-Match", "If-Modified-Since", "If-Match", "If-Unmodified-Since", "If-Range", "Range"}) {
+            if (lbw_net_find_header(req->request_headers_utf8, name)) {
+                req->cacheable = false;
+            }
+        }
     }
 
-    unsigned thread_id = 0;
-    HANDLE thread_handle = reinterpret_cast<HANDLE>(_beginthreadex(
-        nullptr,
-        0,
-        &network_thread_proc,
-        req,
-        0,
-        &thread_id));
-    if (!thread_handle) {
-        CloseHandle(req->completion_event);
-        delete req;
-        return LB_Error_Unknown;
+    if (desc->body_provider) {
+        req->body_provider = desc->body_provider;
+        req->body_provider_ctx = desc->body_provider_ctx;
+        req->body_length = desc->body_length;
+    } else if (desc->body_file_utf8) {
+        req->body_file = lbw_utf8_to_wide(desc->body_file_utf8);
+        if (req->body_file.empty()) {
+            delete req;
+            return LB_Error_BadArgument;
+        }
+    } else if (desc->body && desc->body_size > 0) {
+        if (desc->flags & LB_NetRequestFlag_BorrowBody) {
+            req->body_data = desc->body;
+            req->borrowed_body = true;
+        } else {
+            req->body_storage.assign(desc->body, desc->body + desc->body_size);
+            req->body_data = req->body_storage.data();
+        }
+        req->body_size = desc->body_size;
+    }
+
+    *out = req;
+    return LB_Error_Ok;
+}
+
+static void schedule_request(lb_net_request *req) {
+    {
+        std::lock_guard<std::mutex> lk(g_scheduler.mutex);
+        req->enqueued_us = monotonic_us();
+        req->timing.queued_us = req->enqueued_us;
+        g_scheduler.pending[priority_level(req->priority)].push_back(req);
+        ++g_scheduler.stats.queued;
+    }
+    pump_scheduler();
+}
+
+extern "C" LB_ErrorCode net_request_impl(const LB_NetRequestDesc *desc, LB_NetResponseCallback cb, void *ctx, lb_net_request **out_handle) {
+    if (out_handle) {
+        *out_handle = nullptr;
+    }
+    if (!cb) {
+        return LB_Error_BadArgument;
+    }
+    lb_net_request *req = nullptr;
+    LB_ErrorCode rc = create_request(desc, &req);
+    if (rc != LB_Error_Ok) {
+        return rc;
+    }
+    req->callback = cb;
+    req->callback_ctx = ctx;
+
+    // Identical plain GETs share one transfer while in flight.
+    if (req->method_w == L"GET" && !(desc->flags & LB_NetRequestFlag_NoCache) && !desc->body_provider &&
+        !desc->body_file_utf8 && desc->body_size == 0) {
+        req->coalesce_key = desc->url_utf8;
+        for (size_t i = 0; desc->headers && i < desc->header_count; ++i) {
+            req->coalesce_key += '\n';
+            req->coalesce_key += desc->headers[i].name ? desc->headers[i].name : "";
+            req->coalesce_key += ':';
+            req->coalesce_key += desc->headers[i].value ? desc->headers[i].value : "";
+        }
+    }
+    if (!join_in_flight(req)) {
+        schedule_request(req);
     }
-    req->thread_handle = thread_handle;
 
     if (out_handle) {
         *out_handle = req;
@@ -421,15 +1520,303 @@ extern "C" LB_ErrorCode net_request_impl(const LB_NetRequestDesc *desc, LB_NetRe
     return LB_Error_Ok;
 }
 
+// LB_NetRequestDesc as laid out at ABI version 1, which defined no flags.
+struct NetRequestDescV1 {
+    LB_NetMethod method;
+    const char *custom_method;
+    const char *url_utf8;
+    const LB_NetHeader *headers;
+    size_t header_count;
+    const uint8_t *body;
+    size_t body_size;
+    uint32_t flags;
+};
+
+// net_request as handed to hosts built against ABI version 1.
+extern "C" LB_ErrorCode net_request_v1_impl(const LB_NetRequestDesc *desc, LB_NetResponseCallback cb, void *ctx, lb_net_request **out_handle) {
+    if (!desc) {
+        return net_request_impl(nullptr, cb, ctx, out_handle);
+    }
+    const auto *v1 = reinterpret_cast<const NetRequestDescV1 *>(desc);
+    LB_NetRequestDesc full{};
+    full.method = v1->method;
+    full.custom_method = v1->custom_method;
+    full.url_utf8 = v1->url_utf8;
+    full.headers = v1->headers;
+    full.header_count = v1->header_count;
+    full.body = v1->body;
+    full.body_size = v1->body_size;
+    full.priority = LB_NetPriority_Normal;
+    return net_request_impl(&full, cb, ctx, out_handle);
+}
+
+extern "C" LB_ErrorCode net_request_stream_impl(const LB_NetRequestDesc *desc, const LB_NetStreamCallbacks *callbacks, void *ctx, lb_net_request **out_handle) {
+    if (out_handle) {
+        *out_handle = nullptr;
+    }
+    if (!callbacks || !callbacks->on_complete) {
+        return LB_Error_BadArgument;
+    }
+    lb_net_request *req = nullptr;
+    LB_ErrorCode rc = create_request(desc, &req);
+    if (rc != LB_Error_Ok) {
+        return rc;
+    }
+    req->streaming = true;
+    req->cacheable = false;
+    req->stream_callbacks = *callbacks;
+    req->callback_ctx = ctx;
+    schedule_request(req);
+
+    if (out_handle) {
+        *out_handle = req;
+    }
+    return LB_Error_Ok;
+}
+
+extern "C" void net_request_set_priority_impl(lb_net_request *handle, int32_t priority) {
+    if (!handle) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(g_coalescer.mutex);
+    lb_net_request *target = handle->leader ? handle->leader : handle;
+    if (target != handle) {
+        handle->priority = priority;
+        if (priority <= target->priority) {
+            return;
+        }
+    }
+    reprioritize_request(target, priority);
+}
+
+extern "C" void net_get_scheduler_stats_impl(LB_NetSchedulerStats *out) {
+    if (!out) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(g_scheduler.mutex);
+    *out = g_scheduler.stats;
+}
+
+extern "C" LB_ErrorCode net_get_origin_timing_impl(const char *url_utf8, LB_NetOriginTiming *out) {
+    if (!url_utf8 || !out) {
+        return LB_Error_BadArgument;
+    }
+    std::wstring url_w = lbw_utf8_to_wide(url_utf8);
+    URL_COMPONENTSW components{};
+    components.dwStructSize = sizeof(components);
+    components.dwHostNameLength = (DWORD)-1;
+    if (url_w.empty() || !WinHttpCrackUrl(url_w.c_str(), 0, 0, &components)) {
+        return LB_Error_BadArgument;
+    }
+    std::wstring host(components.lpszHostName, components.dwHostNameLength);
+
+    std::lock_guard<std::mutex> lk(g_timing.mutex);
+    auto it = g_timing.origins.find(origin_key(host, components.nPort));
+    if (it == g_timing.origins.end()) {
+        return LB_Error_NotFound;
+    }
+    *out = it->second;
+    return LB_Error_Ok;
+}
+
+static VOID CALLBACK dns_prefetch_work(PTP_CALLBACK_INSTANCE, PVOID param) {
+    std::unique_ptr<std::wstring> host(static_cast<std::wstring *>(param));
+    // Querying both families fills the system resolver cache that WinHTTP's connect consults.
+    bool resolved = false;
+    for (WORD type : {static_cast<WORD>(DNS_TYPE_A), static_cast<WORD>(DNS_TYPE_AAAA)}) {
+        PDNS_RECORD records = nullptr;
+        if (DnsQuery_W(host->c_str(), type, DNS_QUERY_STANDARD, nullptr, &records, nullptr) == 0) {
+            resolved = true;
+        }
+        if (records) {
+            DnsFree(records, DnsFreeRecordList);
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(g_warmup.mutex);
+    if (resolved) {
+        g_warmup.dns_prefetched[*host] = GetTickCount64();
+    } else {
+        g_warmup.dns_prefetched.erase(*host);
+    }
+}
+
+extern "C" LB_ErrorCode net_dns_prefetch_impl(const char *host_utf8) {
+    if (!host_utf8 || !*host_utf8) {
+        return LB_Error_BadArgument;
+    }
+    std::wstring host = lbw_utf8_to_wide(host_utf8);
+    if (host.empty()) {
+        return LB_Error_BadArgument;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(g_warmup.mutex);
+        ULONGLONG now = GetTickCount64();
+        auto found = g_warmup.dns_prefetched.find(host);
+        if (found != g_warmup.dns_prefetched.end() && (found->second == 0 || now - found->second < kNetDnsPrefetchTtlMs)) {
+            return LB_Error_Ok; // already pending or recently resolved
+        }
+        if (g_warmup.dns_prefetched.size() >= kNetDnsPrefetchMaxHosts) {
+            for (auto it = g_warmup.dns_prefetched.begin(); it != g_warmup.dns_prefetched.end();) {
+                if (it->second != 0 && now - it->second >= kNetDnsPrefetchTtlMs) {
+                    it = g_warmup.dns_prefetched.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            if (g_warmup.dns_prefetched.size() >= kNetDnsPrefetchMaxHosts) {
+                return LB_Error_Busy;
+            }
+        }
+        g_warmup.dns_prefetched[host] = 0;
+        ++g_warmup.stats.dns_prefetches;
+    }
+
+    // Lookups block, so they run on the default pool rather than taking a network worker.
+    auto *param = new std::wstring(host);
+    if (!TrySubmitThreadpoolCallback(&dns_prefetch_work, param, nullptr)) {
+        delete param;
+        std::lock_guard<std::mutex> lk(g_warmup.mutex);
+        g_warmup.dns_prefetched.erase(host);
+        return LB_Error_Unknown;
+    }
+    return LB_Error_Ok;
+}
+
+// Probe connections come from HEAD round trips queued at low priority, so they go through the
+// same per-host limits as real requests and never delay them.
+extern "C" LB_ErrorCode net_preconnect_impl(const char *origin_utf8, uint32_t count, uint32_t flags) {
+    if (!origin_utf8 || count == 0) {
+        return LB_Error_BadArgument;
+    }
+    if (!(flags & LB_NetPreconnectFlag_Probe)) {
+        // Without a probe the only warm-up that sends nothing to the origin is name resolution.
+        std::wstring url_w = lbw_utf8_to_wide(origin_utf8);
+        URL_COMPONENTSW components{};
+        components.dwStructSize = sizeof(components);
+        components.dwHostNameLength = (DWORD)-1;
+        if (url_w.empty() || !WinHttpCrackUrl(url_w.c_str(), 0, 0, &components) || components.dwHostNameLength == 0) {
+            return LB_Error_BadArgument;
+        }
+        return net_dns_prefetch_impl(lbw_wide_to_utf8(components.lpszHostName, components.dwHostNameLength).c_str());
+    }
+    count = std::clamp<uint32_t>(count, 1, kNetMaxConnectionsPerHost);
+
+    LB_NetRequestDesc desc{};
+    desc.method = LB_NetMethod_Custom;
+    desc.custom_method = "HEAD";
+    desc.url_utf8 = origin_utf8;
+    desc.flags = LB_NetRequestFlag_NoCache;
+    desc.priority = LB_NetPriority_Low;
+    for (uint32_t i = 0; i < count; ++i) {
+        lb_net_request *req = nullptr;
+        LB_ErrorCode rc = create_request(&desc, &req);
+        if (rc != LB_Error_Ok) {
+            return rc;
+        }
+        req->preconnect = true;
+        {
+            std::lock_guard<std::mutex> lk(g_warmup.mutex);
+            ++g_warmup.stats.preconnects;
+        }
+        schedule_request(req);
+    }
+    return LB_Error_Ok;
+}
+
+extern "C" void net_get_preconnect_stats_impl(LB_NetPreconnectStats *out) {
+    if (!out) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(g_warmup.mutex);
+    ULONGLONG now = GetTickCount64();
+    for (auto it = g_warmup.warm_connections.begin(); it != g_warmup.warm_connections.end();) {
+        expire_warm_connections_locked(it->second, now);
+        it = it->second.empty() ? g_warmup.warm_connections.erase(it) : std::next(it);
+    }
+    *out = g_warmup.stats;
+}
+
+// Stops a transfer nobody is subscribed to any more: a queued request is dropped on the spot. A
+// running one is left to its worker, which owns the synchronous WinHTTP handle and closes it
+// once the call it is blocked in returns and it sees the transfer abandoned.
+static void abandon_transfer(lb_net_request *req) {
+    {
+        // Wake a streaming worker waiting for the delivery window.
+        std::lock_guard<std::mutex> lk(req->stream_mutex);
+    }
+    req->stream_space.notify_all();
+    if (unschedule_request(req)) {
+        take_followers(req);
+        if (req->sink.on_complete) {
+            complete_sink(req, LB_Error_Unknown);
+        } else {
+            release_request(req);
+        }
+        return;
+    }
+    if (req->borrowed_body) {
+        // Waits out at most one chunk copy; the worker sees the abandonment before the next.
+        std::lock_guard<std::mutex> lk(req->borrow_mutex);
+    }
+}
+
+// Returns without waiting for the worker. The event thread checks `cancelled` before every
+// callback, so cancelling there guarantees nothing fires afterwards.
 extern "C" void net_request_cancel_impl(lb_net_request *handle) {
     if (!handle) {
         return;
     }
-    handle->cancelled.store(true);
-    if (handle->completion_event) {
-        WaitForSingleObject(handle->completion_event, INFINITE);
+    // Once `cancelled` is set the worker may finish and drop its reference at any moment, so
+    // cancel holds its own until it is done.
+    handle->refs.fetch_add(1);
+    if (handle->cancelled.exchange(true)) {
+        release_request(handle);
+        return;
+    }
+    // A follower that never reached the scheduler just leaves; the shared transfer carries on
+    // without it, and a leader keeps running while coalesced followers still want the response.
+    if (!leave_in_flight(handle) && handle->subscribers.fetch_sub(1) == 1) {
+        abandon_transfer(handle);
     }
-    if (!handle->callback_scheduled.load()) {
-        finalize_request(handle);
+    release_request(handle);
+}
+
+LB_ErrorCode lbw_net_start_transfer(const char *url_utf8, const NetHeaderList &headers, int32_t priority,
+                                    const NetTransferSink &sink, lb_net_request **out) {
+    std::vector<LB_NetHeader> desc_headers;
+    for (const auto &header : headers) {
+        desc_headers.push_back(LB_NetHeader{header.first.c_str(), header.second.c_str()});
+    }
+    LB_NetRequestDesc desc{};
+    desc.method = LB_NetMethod_Get;
+    desc.url_utf8 = url_utf8;
+    desc.headers = desc_headers.data();
+    desc.header_count = desc_headers.size();
+    desc.flags = LB_NetRequestFlag_NoCache;
+    desc.priority = priority;
+
+    lb_net_request *req = nullptr;
+    LB_ErrorCode rc = create_request(&desc, &req);
+    if (rc != LB_Error_Ok) {
+        return rc;
     }
+    req->sink = sink;
+    req->refs.fetch_add(1); // the caller's
+    *out = req;
+    schedule_request(req);
+    return LB_Error_Ok;
+}
+
+void lbw_net_cancel_transfer(lb_net_request *req) {
+    net_request_cancel_impl(req);
+}
+
+void lbw_net_retain_transfer(lb_net_request *req) {
+    req->refs.fetch_add(1);
+}
+
+void lbw_net_release_transfer(lb_net_request *req) {
+    release_request(req);
 }
@@ -0,0 +1,666 @@
+#include <windows.h>
+#include <winhttp.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <objbase.h>
+
+#include "lb_platform.h"
+#include "win_net_internal.h"
+#include "win_utf.h"
+
+extern "C" LB_ErrorCode fs_read_entire_file_impl(const char *path_utf8, LB_FileResult *out);
+extern "C" LB_ErrorCode fs_write_file_ex_impl(const char *path_utf8, const void *data, size_t size, uint32_t flags);
+extern "C" LB_ErrorCode fs_remove_file_impl(const char *path_utf8);
+extern "C" LB_ErrorCode fs_list_directory_ex_impl(const char *path_utf8, LB_DirectoryListingEx *out);
+
+// On-disk entry: "LBHC", format version, then the serialized NetCacheEntry.
+static const uint32_t kNetCacheFileMagic = 0x4348424C;
+static const uint32_t kNetCacheFileVersion = 1;
+static const char kNetCacheFileSuffix[] = ".lbc";
+// Upper bound for heuristic freshness (10% of the time since Last-Modified).
+static const uint64_t kNetCacheMaxHeuristicLifetime = 24 * 60 * 60;
+
+struct DiskRecord {
+    uint64_t size{};
+    uint64_t last_used{}; // FILETIME ticks, seeded from the file's mtime
+};
+
+struct NetCache {
+    std::mutex mutex;
+    uint64_t memory_capacity{};
+    uint64_t disk_capacity{};
+    std::string disk_dir; // empty = no disk tier
+    std::list<std::shared_ptr<const NetCacheEntry>> lru; // most recently used at the front
+    std::unordered_map<std::string, std::list<std::shared_ptr<const NetCacheEntry>>::iterator> index;
+    std::unordered_map<std::string, DiskRecord> disk; // keyed by file name
+    uint64_t disk_clock{};
+    LB_NetCacheStats stats{};
+};
+
+static NetCache g_cache;
+
+static bool ascii_iequals(const std::string &a, const char *b) {
+    size_t length = strlen(b);
+    if (a.size() != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        char x = a[i];
+        char y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string *lbw_net_find_header(const NetHeaderList &headers, const char *name) {
+    for (const auto &header : headers) {
+        if (ascii_iequals(header.first, name)) {
+            return &header.second;
+        }
+    }
+    return nullptr;
+}
+
+static uint64_t filetime_ticks(const FILETIME &ft) {
+    return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+static uint64_t unix_now() {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    return filetime_ticks(ft) / 10000000ull - 11644473600ull;
+}
+
+static bool parse_http_date(const std::string *value, uint64_t &out) {
+    if (!value) {
+        return false;
+    }
+    WideStackString wide(value->c_str());
+    SYSTEMTIME st;
+    FILETIME ft;
+    if (!WinHttpTimeToSystemTime(wide.c_str(), &st) || !SystemTimeToFileTime(&st, &ft)) {
+        return false;
+    }
+    uint64_t seconds = filetime_ticks(ft) / 10000000ull;
+    if (seconds < 11644473600ull) {
+        return false;
+    }
+    out = seconds - 11644473600ull;
+    return true;
+}
+
+struct CacheControl {
+    bool no_store{};
+    bool no_cache{};
+    bool has_max_age{};
+    uint64_t max_age{};
+};
+
+static CacheControl parse_cache_control(const NetHeaderList &headers) {
+    CacheControl cc;
+    for (const auto &header : headers) {
+        bool pragma = ascii_iequals(header.first, "Pragma");
+        if (!pragma && !ascii_iequals(header.first, "Cache-Control")) {
+            continue;
+        }
+        size_t pos = 0;
+        const std::string &value = header.second;
+        while (pos < value.size()) {
+            size_t end = value.find(',', pos);
+            if (end == std::string::npos) {
+                end = value.size();
+            }
+            std::string directive = value.substr(pos, end - pos);
+            pos = end + 1;
+            directive.erase(0, directive.find_first_not_of(" \t"));
+            directive.erase(directive.find_last_not_of(" \t") + 1);
+            std::string argument;
+            size_t eq = directive.find('=');
+            if (eq != std::string::npos) {
+                argument = directive.substr(eq + 1);
+                directive.resize(eq);
+            }
+            if (ascii_iequals(directive, "no-cache")) {
+                cc.no_cache = true;
+            } else if (pragma) {
+                continue;
+            } else if (ascii_iequals(directive, "no-store")) {
+                cc.no_store = true;
+            } else if (ascii_iequals(directive, "max-age")) {
+                if (!argument.empty() && argument.front() == '"') {
+                    argument = argument.substr(1, argument.find('"', 1) - 1);
+                }
+                cc.has_max_age = true;
+                cc.max_age = strtoull(argument.c_str(), nullptr, 10);
+            }
+        }
+    }
+    return cc;
+}
+
+// RFC 9111 freshness lifetime for a private cache: max-age, then Expires - Date, then a
+// Last-Modified heuristic.
+static uint64_t freshness_lifetime(const NetHeaderList &headers, uint64_t response_time) {
+    CacheControl cc = parse_cache_control(headers);
+    if (cc.no_cache) {
+        return 0;
+    }
+    if (cc.has_max_age) {
+        return cc.max_age;
+    }
+    uint64_t date = response_time;
+    parse_http_date(lbw_net_find_header(headers, "Date"), date);
+    uint64_t expires = 0;
+    if (lbw_net_find_header(headers, "Expires")) {
+        return parse_http_date(lbw_net_find_header(headers, "Expires"), expires) && expires > date ? expires - date : 0;
+    }
+    uint64_t last_modified = 0;
+    if (parse_http_date(lbw_net_find_header(headers, "Last-Modified"), last_modified) && last_modified < date) {
+        return std::min<uint64_t>((date - last_modified) / 10, kNetCacheMaxHeuristicLifetime);
+    }
+    return 0;
+}
+
+static bool is_fresh(const NetCacheEntry &entry, uint64_t now) {
+    uint64_t resident = now > entry.response_time ? now - entry.response_time : 0;
+    return entry.lifetime > entry.initial_age + resident;
+}
+
+static bool vary_matches(const NetCacheEntry &entry, const NetHeaderList &request_headers) {
+    for (const auto &vary : entry.vary) {
+        const std::string *value = lbw_net_find_header(request_headers, vary.first.c_str());
+        if ((value ? *value : std::string()) != vary.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t entry_cost(const NetCacheEntry &entry) {
+    uint64_t cost = entry.url.size() + entry.body->size();
+    for (const auto &header : entry.headers) {
+        cost += header.first.size() + header.second.size();
+    }
+    return cost;
+}
+
+static std::string disk_file_name(const std::string &url) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : url) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    static const char digits[] = "0123456789abcdef";
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        name[static_cast<size_t>(i)] = digits[hash & 0xf];
+        hash >>= 4;
+    }
+    return name + kNetCacheFileSuffix;
+}
+
+static void put_u32(std::vector<uint8_t> &out, uint32_t value) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+static void put_u64(std::vector<uint8_t> &out, uint64_t value) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+static void put_string(std::vector<uint8_t> &out, const std::string &value) {
+    put_u32(out, static_cast<uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+static void put_headers(std::vector<uint8_t> &out, const NetHeaderList &headers) {
+    put_u32(out, static_cast<uint32_t>(headers.size()));
+    for (const auto &header : headers) {
+        put_string(out, header.first);
+        put_string(out, header.second);
+    }
+}
+
+struct Reader {
+    const uint8_t *data;
+    size_t size;
+    size_t pos{};
+    bool ok{true};
+
+    bool take(void *out, size_t length) {
+        if (!ok || size - pos < length) {
+            ok = false;
+            return false;
+        }
+        memcpy(out, data + pos, length);
+        pos += length;
+        return true;
+    }
+    uint32_t u32() { uint32_t v = 0; take(&v, sizeof(v)); return v; }
+    uint64_t u64() { uint64_t v = 0; take(&v, sizeof(v)); return v; }
+    std::string string() {
+        uint32_t length = u32();
+        if (!ok || size - pos < length) {
+            ok = false;
+            return {};
+        }
+        std::string value(reinterpret_cast<const char *>(data + pos), length);
+        pos += length;
+        return value;
+    }
+    NetHeaderList headers() {
+        NetHeaderList list;
+        uint32_t count = u32();
+        for (uint32_t i = 0; i < count && ok; ++i) {
+            std::string name = string();
+            std::string value = string();
+            list.emplace_back(std::move(name), std::move(value));
+        }
+        return list;
+    }
+};
+
+static std::vector<uint8_t> serialize_entry(const NetCacheEntry &entry) {
+    std::vector<uint8_t> out;
+    out.reserve(static_cast<size_t>(entry_cost(entry)) + 256);
+    put_u32(out, kNetCacheFileMagic);
+    put_u32(out, kNetCacheFileVersion);
+    put_string(out, entry.url);
+    put_u32(out, entry.status);
+    put_u64(out, entry.response_time);
+    put_u64(out, entry.initial_age);
+    put_u64(out, entry.lifetime);
+    put_headers(out, entry.headers);
+    put_headers(out, entry.vary);
+    put_u64(out, entry.body->size());
+    out.insert(out.end(), entry.body->begin(), entry.body->end());
+    return out;
+}
+
+static std::shared_ptr<const NetCacheEntry> deserialize_entry(const uint8_t *data, size_t size) {
+    Reader reader{data, size};
+    if (reader.u32() != kNetCacheFileMagic || reader.u32() != kNetCacheFileVersion) {
+        return nullptr;
+    }
+    auto entry = std::make_shared<NetCacheEntry>();
+    entry->url = reader.string();
+    entry->status = reader.u32();
+    entry->response_time = reader.u64();
+    entry->initial_age = reader.u64();
+    entry->lifetime = reader.u64();
+    entry->headers = reader.headers();
+    entry->vary = reader.headers();
+    uint64_t body_size = reader.u64();
+    if (!reader.ok || body_size != reader.size - reader.pos) {
+        return nullptr;
+    }
+    entry->body = std::make_shared<const std::vector<uint8_t>>(data + reader.pos, data + reader.size);
+    return entry;
+}
+
+static void erase_memory_entry(NetCache &cache, std::list<std::shared_ptr<const NetCacheEntry>>::iterator it) {
+    cache.stats.memory_bytes -= entry_cost(**it);
+    cache.index.erase((*it)->url);
+    cache.lru.erase(it);
+}
+
+static void insert_memory_entry(NetCache &cache, const std::shared_ptr<const NetCacheEntry> &entry) {
+    auto found = cache.index.find(entry->url);
+    if (found != cache.index.end()) {
+        erase_memory_entry(cache, found->second);
+    }
+    uint64_t cost = entry_cost(*entry);
+    if (cost > cache.memory_capacity) {
+        return;
+    }
+    cache.lru.push_front(entry);
+    cache.index[entry->url] = cache.lru.begin();
+    cache.stats.memory_bytes += cost;
+    while (cache.stats.memory_bytes > cache.memory_capacity && !cache.lru.empty()) {
+        erase_memory_entry(cache, std::prev(cache.lru.end()));
+        ++cache.stats.evictions;
+    }
+}
+
+static std::string disk_path(const NetCache &cache, const std::string &name) {
+    return cache.disk_dir + "\\" + name;
+}
+
+// Drops least recently used disk entries until the tier fits; returns the paths to delete.
+static std::vector<std::string> trim_disk_locked(NetCache &cache) {
+    std::vector<std::string> doomed;
+    while (cache.stats.disk_bytes > cache.disk_capacity && !cache.disk.empty()) {
+        auto oldest = cache.disk.begin();
+        for (auto it = cache.disk.begin(); it != cache.disk.end(); ++it) {
+            if (it->second.last_used < oldest->second.last_used) {
+                oldest = it;
+            }
+        }
+        cache.stats.disk_bytes -= oldest->second.size;
+        doomed.push_back(disk_path(cache, oldest->first));
+        cache.disk.erase(oldest);
+        ++cache.stats.evictions;
+    }
+    return doomed;
+}
+
+static void write_disk_entry(const std::shared_ptr<const NetCacheEntry> &entry) {
+    std::string dir;
+    std::string name = disk_file_name(entry->url);
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        dir = g_cache.disk_dir;
+    }
+    if (dir.empty()) {
+        return;
+    }
+    std::vector<uint8_t> blob = serialize_entry(*entry);
+    std::string path = dir + "\\" + name;
+    if (fs_write_file_ex_impl(path.c_str(), blob.data(), blob.size(), LB_WriteFlag_Atomic) != LB_Error_Ok) {
+        return;
+    }
+
+    std::vector<std::string> doomed;
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        if (g_cache.disk_dir != dir) {
+            return;
+        }
+        DiskRecord &record = g_cache.disk[name];
+        g_cache.stats.disk_bytes -= record.size;
+        record.size = blob.size();
+        record.last_used = ++g_cache.disk_clock;
+        g_cache.stats.disk_bytes += record.size;
+        doomed = trim_disk_locked(g_cache);
+    }
+    for (const auto &victim : doomed) {
+        fs_remove_file_impl(victim.c_str());
+    }
+}
+
+static std::shared_ptr<const NetCacheEntry> read_disk_entry(const std::string &url) {
+    std::string name = disk_file_name(url);
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        auto it = g_cache.disk.find(name);
+        if (g_cache.disk_dir.empty() || it == g_cache.disk.end()) {
+            return nullptr;
+        }
+        it->second.last_used = ++g_cache.disk_clock;
+        path = disk_path(g_cache, name);
+    }
+    LB_FileResult file{};
+    if (fs_read_entire_file_impl(path.c_str(), &file) != LB_Error_Ok) {
+        return nullptr;
+    }
+    auto entry = deserialize_entry(file.buffer.data, file.buffer.size);
+    CoTaskMemFree(file.buffer.data);
+    if (!entry || entry->url != url) {
+        return nullptr;
+    }
+    return entry;
+}
+
+bool lbw_net_cache_enabled() {
+    std::lock_guard<std::mutex> lk(g_cache.mutex);
+    return g_cache.memory_capacity > 0 || !g_cache.disk_dir.empty();
+}
+
+NetCacheLookup lbw_net_cache_lookup(const std::string &url, const NetHeaderList &request_headers,
+                                    std::shared_ptr<const NetCacheEntry> &out) {
+    out.reset();
+    CacheControl request_cc = parse_cache_control(request_headers);
+    if (request_cc.no_store) {
+        return NetCacheLookup::Miss;
+    }
+
+    std::shared_ptr<const NetCacheEntry> entry;
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        auto found = g_cache.index.find(url);
+        if (found != g_cache.index.end()) {
+            g_cache.lru.splice(g_cache.lru.begin(), g_cache.lru, found->second);
+            entry = *found->second;
+        }
+    }
+    if (!entry) {
+        entry = read_disk_entry(url);
+        if (entry) {
+            std::lock_guard<std::mutex> lk(g_cache.mutex);
+            insert_memory_entry(g_cache, entry);
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(g_cache.mutex);
+    if (!entry || !vary_matches(*entry, request_headers)) {
+        ++g_cache.stats.misses;
+        return NetCacheLookup::Miss;
+    }
+    out = entry;
+    if (!request_cc.no_cache && is_fresh(*entry, unix_now())) {
+        ++g_cache.stats.hits;
+        g_cache.stats.bytes_saved += entry->body->size();
+        return NetCacheLookup::Fresh;
+    }
+    if (!lbw_net_find_header(entry->headers, "ETag") && !lbw_net_find_header(entry->headers, "Last-Modified")) {
+        // Nothing to revalidate with; refetch as a plain miss.
+        out.reset();
+        ++g_cache.stats.misses;
+        return NetCacheLookup::Miss;
+    }
+    return NetCacheLookup::Stale;
+}
+
+void lbw_net_cache_add_validators(const NetCacheEntry &entry, NetHeaderList &request_headers) {
+    if (const std::string *etag = lbw_net_find_header(entry.headers, "ETag")) {
+        request_headers.emplace_back("If-None-Match", *etag);
+    }
+    if (const std::string *last_modified = lbw_net_find_header(entry.headers, "Last-Modified")) {
+        request_headers.emplace_back("If-Modified-Since", *last_modified);
+    }
+}
+
+static bool is_cacheable_status(uint32_t status) {
+    switch (status) {
+        case 200: case 203: case 204: case 300: case 301: case 308: case 404: case 410:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static std::shared_ptr<NetCacheEntry> build_entry(const std::string &url, const NetHeaderList &request_headers,
+                                                  uint32_t status, const NetHeaderList &headers) {
+    if (!is_cacheable_status(status) || parse_cache_control(request_headers).no_store) {
+        return nullptr;
+    }
+    CacheControl cc = parse_cache_control(headers);
+    if (cc.no_store) {
+        return nullptr;
+    }
+
+    auto entry = std::make_shared<NetCacheEntry>();
+    entry->url = url;
+    entry->status = status;
+    entry->headers = headers;
+    entry->response_time = unix_now();
+    if (const std::string *age = lbw_net_find_header(headers, "Age")) {
+        entry->initial_age = strtoull(age->c_str(), nullptr, 10);
+    }
+    entry->lifetime = freshness_lifetime(headers, entry->response_time);
+
+    if (const std::string *vary = lbw_net_find_header(headers, "Vary")) {
+        size_t pos = 0;
+        while (pos < vary->size()) {
+            size_t end = vary->find(',', pos);
+            if (end == std::string::npos) {
+                end = vary->size();
+            }
+            std::string name = vary->substr(pos, end - pos);
+            pos = end + 1;
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (name == "*") {
+                return nullptr;
+            }
+            if (!name.empty()) {
+                const std::string *value = lbw_net_find_header(request_headers, name.c_str());
+                entry->vary.emplace_back(name, value ? *value : std::string());
+            }
+        }
+    }
+
+    bool has_validator = lbw_net_find_header(headers, "ETag") || lbw_net_find_header(headers, "Last-Modified");
+    if (entry->lifetime == 0 && !has_validator) {
+        return nullptr;
+    }
+    return entry;
+}
+
+static void publish_entry(const std::shared_ptr<const NetCacheEntry> &entry) {
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        insert_memory_entry(g_cache, entry);
+        ++g_cache.stats.stores;
+    }
+    write_disk_entry(entry);
+}
+
+void lbw_net_cache_store(const std::string &url, const NetHeaderList &request_headers, uint32_t status,
+                         const NetHeaderList &headers, const uint8_t *body, size_t body_size) {
+    auto entry = build_entry(url, request_headers, status, headers);
+    if (!entry) {
+        return;
+    }
+    entry->body = std::make_shared<const std::vector<uint8_t>>(body, body + body_size);
+    publish_entry(entry);
+}
+
+std::shared_ptr<const NetCacheEntry> lbw_net_cache_revalidated(const std::shared_ptr<const NetCacheEntry> &entry,
+                                                               const NetHeaderList &not_modified_headers) {
+    // Headers from the 304 replace the stored ones of the same name (RFC 9111 section 4.3.4),
+    // except those describing the stored body, which is always kept decoded.
+    auto describes_body = [](const std::string &name) {
+        return ascii_iequals(name, "Content-Length") || ascii_iequals(name, "Content-Encoding");
+    };
+    NetHeaderList merged = entry->headers;
+    for (const auto &header : not_modified_headers) {
+        if (describes_body(header.first)) {
+            continue;
+        }
+        merged.erase(std::remove_if(merged.begin(), merged.end(), [&](const auto &existing) {
+                         return ascii_iequals(existing.first, header.first.c_str());
+                     }),
+                     merged.end());
+    }
+    for (const auto &header : not_modified_headers) {
+        if (!describes_body(header.first)) {
+            merged.push_back(header);
+        }
+    }
+
+    auto refreshed = std::make_shared<NetCacheEntry>();
+    refreshed->url = entry->url;
+    refreshed->status = entry->status;
+    refreshed->headers = std::move(merged);
+    refreshed->vary = entry->vary;
+    refreshed->body = entry->body;
+    refreshed->response_time = unix_now();
+    if (const std::string *age = lbw_net_find_header(not_modified_headers, "Age")) {
+        refreshed->initial_age = strtoull(age->c_str(), nullptr, 10);
+    }
+    refreshed->lifetime = freshness_lifetime(refreshed->headers, refreshed->response_time);
+
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        ++g_cache.stats.revalidations;
+        g_cache.stats.bytes_saved += refreshed->body->size();
+    }
+    if (parse_cache_control(refreshed->headers).no_store) {
+        return refreshed;
+    }
+    publish_entry(refreshed);
+    return refreshed;
+}
+
+void lbw_net_cache_count_miss() {
+    std::lock_guard<std::mutex> lk(g_cache.mutex);
+    ++g_cache.stats.misses;
+}
+
+extern "C" LB_ErrorCode net_cache_configure_impl(const char *disk_dir_utf8, uint64_t memory_bytes, uint64_t disk_bytes) {
+    std::string dir = (disk_dir_utf8 && disk_bytes > 0) ? disk_dir_utf8 : "";
+    while (!dir.empty() && (dir.back() == '\\' || dir.back() == '/')) {
+        dir.pop_back();
+    }
+
+    // Index the existing disk tier outside the lock, oldest files first in line for eviction.
+    std::unordered_map<std::string, DiskRecord> disk;
+    uint64_t disk_total = 0;
+    if (!dir.empty()) {
+        WideStackString dir_w(dir.c_str());
+        if (!CreateDirectoryW(dir_w.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+            return LB_Error_Unknown;
+        }
+        LB_DirectoryListingEx listing{};
+        if (fs_list_directory_ex_impl(dir.c_str(), &listing) == LB_Error_Ok) {
+            const char *names = reinterpret_cast<const char *>(listing.buffer.data);
+            size_t suffix_length = sizeof(kNetCacheFileSuffix) - 1;
+            for (size_t i = 0; i < listing.count; ++i) {
+                const LB_DirectoryEntry &item = listing.entries[i];
+                std::string name(names + item.name_offset, item.name_length);
+                if (item.is_directory || name.size() <= suffix_length ||
+                    name.compare(name.size() - suffix_length, suffix_length, kNetCacheFileSuffix) != 0) {
+                    continue;
+                }
+                disk[name] = DiskRecord{item.size, item.modified_timestamp};
+                disk_total += item.size;
+            }
+            CoTaskMemFree(listing.buffer.data);
+        }
+    }
+
+    std::vector<std::string> doomed;
+    {
+        std::lock_guard<std::mutex> lk(g_cache.mutex);
+        g_cache.memory_capacity = memory_bytes;
+        while (g_cache.stats.memory_bytes > g_cache.memory_capacity && !g_cache.lru.empty()) {
+            erase_memory_entry(g_cache, std::prev(g_cache.lru.end()));
+            ++g_cache.stats.evictions;
+        }
+        g_cache.disk_dir = dir;
+        g_cache.disk_capacity = dir.empty() ? 0 : disk_bytes;
+        g_cache.disk = std::move(disk);
+        g_cache.stats.disk_bytes = disk_total;
+        g_cache.disk_clock = 0;
+        for (const auto &record : g_cache.disk) {
+            g_cache.disk_clock = std::max<uint64_t>(g_cache.disk_clock, record.second.last_used);
+        }
+        doomed = trim_disk_locked(g_cache);
+    }
+    for (const auto &victim : doomed) {
+        fs_remove_file_impl(victim.c_str());
+    }
+    return LB_Error_Ok;
+}
+
+extern "C" void net_cache_get_stats_impl(LB_NetCacheStats *out) {
+    if (!out) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(g_cache.mutex);
+    *out = g_cache.stats;
+}
@@ -0,0 +1,585 @@
+#include <windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <objbase.h>
+
+#include "lb_platform.h"
+#include "win_net_internal.h"
+#include "win_utf.h"
+
+extern "C" void post_task_impl(void (*fn)(void *), void *ctx);
+extern "C" LB_ErrorCode fs_read_entire_file_impl(const char *path_utf8, LB_FileResult *out);
+extern "C" LB_ErrorCode fs_write_file_ex_impl(const char *path_utf8, const void *data, size_t size, uint32_t flags);
+extern "C" LB_ErrorCode fs_remove_file_impl(const char *path_utf8);
+
+// Attempts per segment after the first one; each retry resumes where the last one stopped.
+static const uint32_t kNetDownloadMaxRetries = 3;
+// Upper bound on parallel range requests; the scheduler's per-host limit applies on top.
+static const uint32_t kNetDownloadMaxConnections = 6;
+// Segments smaller than this are not worth a connection of their own.
+static const uint64_t kNetDownloadMinSegmentBytes = 1024 * 1024;
+// First line of the "<path>.part.meta" resume record.
+static const char kNetDownloadMetaMagic[] = "LBDL1";
+
+// A download is one or more byte-range segments of the same resource, each fetched by an
+// internal transfer that writes its chunks straight into "<path>.part" at the segment's offset.
+// The first (primary) segment learns the size and validator and may split the rest of the body
+// into parallel segments. The part file is renamed over the target once every segment is done.
+struct NetDownloadSegment {
+    lb_net_download *download{};
+    lb_net_request *transfer{}; // attempt in flight, nullptr between attempts
+    uint64_t offset{};          // next byte to write
+    uint64_t end{};             // exclusive; 0 = until the end of the body
+    uint32_t attempts{};
+    bool primary{};
+    bool in_flight{};
+    bool done{};
+};
+
+struct lb_net_download {
+    // One for completion delivery, plus one for each call that may still touch the download
+    // after the attempt it started has finished on another thread.
+    std::atomic<uint32_t> refs{1};
+    std::atomic<bool> cancelled{false};
+    LB_NetDownloadCallbacks callbacks{};
+    void *callback_ctx{};
+    std::string url;
+    NetHeaderList headers;
+    int32_t priority{};
+    uint32_t max_connections{1};
+    std::wstring path;
+    std::wstring part_path;
+    std::string part_path_utf8;
+    std::string meta_path_utf8;
+    HANDLE file{INVALID_HANDLE_VALUE};
+
+    std::mutex mutex; // guards everything below except the atomics
+    std::vector<std::unique_ptr<NetDownloadSegment>> segments; // in file order
+    std::vector<lb_net_request *> transfers; // every attempt, released with the download
+    uint32_t live{};          // segments not settled yet
+    std::string validator;    // strong ETag or Last-Modified, sent as If-Range
+    bool ranges{};            // the server honours byte ranges
+    uint32_t http_status{};
+    LB_ErrorCode error{LB_Error_Ok};
+
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> progress_pending{false};
+};
+
+static void start_attempt(NetDownloadSegment *segment);
+
+static void destroy_download(lb_net_download *download) {
+    for (lb_net_request *transfer : download->transfers) {
+        lbw_net_release_transfer(transfer);
+    }
+    delete download;
+}
+
+static void release_download(lb_net_download *download) {
+    if (download->refs.fetch_sub(1) == 1) {
+        destroy_download(download);
+    }
+}
+
+// Progress is coalesced to one pending event. Tasks run in posting order and every progress
+// event is posted before the segment that produced it completes, so the download is still alive
+// when it is delivered.
+static void deliver_download_progress(void *ctx) {
+    auto *download = static_cast<lb_net_download *>(ctx);
+    download->progress_pending.store(false);
+    if (!download->cancelled.load() && download->callbacks.on_progress) {
+        download->callbacks.on_progress(download->received.load(), download->total.load(), download->callback_ctx);
+    }
+}
+
+static void post_download_progress(lb_net_download *download) {
+    if (download->callbacks.on_progress && !download->progress_pending.exchange(true)) {
+        post_task_impl(&deliver_download_progress, download);
+    }
+}
+
+static void deliver_download_complete(void *ctx) {
+    auto *download = static_cast<lb_net_download *>(ctx);
+    if (!download->cancelled.load()) {
+        download->callbacks.on_complete(download->error, download->http_status, download->callback_ctx);
+    }
+    release_download(download);
+}
+
+static bool parse_u64(const char *text, const char *end, uint64_t &out) {
+    if (text == end) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (const char *p = text; p != end; ++p) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+    }
+    out = value;
+    return true;
+}
+
+// Parses "bytes first-last/length" or "bytes */length"; `length` is 0 when given as "*".
+static bool parse_content_range(const std::string &value, uint64_t &first, uint64_t &length) {
+    if (value.compare(0, 6, "bytes ") != 0) {
+        return false;
+    }
+    size_t slash = value.find('/');
+    if (slash == std::string::npos) {
+        return false;
+    }
+    const char *base = value.c_str();
+    length = 0;
+    if (value.compare(slash + 1, std::string::npos, "*") != 0 &&
+        !parse_u64(base + slash + 1, base + value.size(), length)) {
+        return false;
+    }
+    if (value.compare(6, slash - 6, "*") == 0) {
+        first = 0;
+        return true;
+    }
+    size_t dash = value.find('-', 6);
+    return dash != std::string::npos && dash < slash && parse_u64(base + 6, base + dash, first);
+}
+
+static bool truncate_part(lb_net_download *download, uint64_t length) {
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(length);
+    return SetFilePointerEx(download->file, position, nullptr, FILE_BEGIN) && SetEndOfFile(download->file);
+}
+
+// Splits what is left after the primary segment's offset into up to max_connections segments.
+static void split_segments_locked(lb_net_download *download, NetDownloadSegment *primary,
+                                  std::vector<NetDownloadSegment *> &spawned) {
+    uint64_t total = download->total.load();
+    uint64_t remaining = total - primary->offset;
+    uint64_t count = std::min<uint64_t>(download->max_connections, remaining / kNetDownloadMinSegmentBytes);
+    if (count < 2) {
+        return;
+    }
+    uint64_t size = remaining / count;
+    primary->end = primary->offset + size;
+    for (uint64_t i = 1; i < count; ++i) {
+        auto segment = std::make_unique<NetDownloadSegment>();
+        segment->download = download;
+        segment->offset = primary->offset + i * size;
+        segment->end = i + 1 == count ? total : segment->offset + size;
+        spawned.push_back(segment.get());
+        download->segments.push_back(std::move(segment));
+        ++download->live;
+    }
+}
+
+static bool segment_response(void *ctx, uint32_t status, const NetHeaderList &headers) {
+    auto *segment = static_cast<NetDownloadSegment *>(ctx);
+    lb_net_download *download = segment->download;
+    std::vector<NetDownloadSegment *> spawned;
+    {
+        std::lock_guard<std::mutex> lk(download->mutex);
+        download->http_status = status;
+        const std::string *content_range = lbw_net_find_header(headers, "Content-Range");
+        uint64_t first = 0;
+        uint64_t length = 0;
+
+        if (status == 206) {
+            if (!content_range || !parse_content_range(*content_range, first, length) || first != segment->offset) {
+                download->error = LB_Error_Unknown;
+                return false;
+            }
+            download->ranges = true;
+            if (length > 0) {
+                download->total.store(length);
+            }
+        } else if (status == 200) {
+            if (!segment->primary || download->segments.size() > 1) {
+                // The resource changed under a parallel download; the pieces cannot be combined.
+                download->error = LB_Error_Unknown;
+                return false;
+            }
+            if (segment->offset > 0) {
+                // The server ignored the range or If-Range no longer matched: start over.
+                if (!truncate_part(download, 0)) {
+                    download->error = LB_Error_Unknown;
+                    return false;
+                }
+                segment->offset = 0;
+                download->received.store(0);
+            }
+            const std::string *accept_ranges = lbw_net_find_header(headers, "Accept-Ranges");
+            download->ranges = accept_ranges && *accept_ranges == "bytes";
+            const std::string *content_length = lbw_net_find_header(headers, "Content-Length");
+            uint64_t total = 0;
+            if (content_length && parse_u64(content_length->c_str(), content_length->c_str() + content_length->size(), total)) {
+                download->total.store(total);
+            }
+        } else if (status == 416 && segment->primary && segment->offset > 0 && content_range &&
+                   parse_content_range(*content_range, first, length) && length == segment->offset) {
+            // A resumed download that was already complete on disk; report it like any other
+            // finished resume rather than with the 416 that told us so.
+            download->http_status = 206;
+            download->total.store(length);
+            segment->done = true;
+            return false;
+        } else {
+            download->error = LB_Error_Unknown;
+            return false;
+        }
+
+        if (segment->primary) {
+            const std::string *etag = lbw_net_find_header(headers, "ETag");
+            const std::string *last_modified = lbw_net_find_header(headers, "Last-Modified");
+            if (etag && etag->compare(0, 2, "W/") != 0) {
+                download->validator = *etag;
+            } else if (last_modified) {
+                download->validator = *last_modified;
+            } else {
+                download->validator.clear();
+            }
+            if (status == 206 && download->max_connections > 1 && download->segments.size() == 1 &&
+                download->total.load() > segment->offset) {
+                split_segments_locked(download, segment, spawned);
+            }
+        }
+    }
+
+    post_download_progress(download);
+    for (NetDownloadSegment *extra : spawned) {
+        start_attempt(extra);
+    }
+    return true;
+}
+
+static bool segment_data(void *ctx, const uint8_t *data, size_t size) {
+    auto *segment = static_cast<NetDownloadSegment *>(ctx);
+    lb_net_download *download = segment->download;
+    uint64_t offset = 0;
+    uint64_t end = 0;
+    {
+        std::lock_guard<std::mutex> lk(download->mutex);
+        offset = segment->offset;
+        end = segment->end;
+    }
+    // The primary segment asks for everything from its offset and is only trimmed afterwards.
+    size_t to_write = end != 0 ? static_cast<size_t>(std::min<uint64_t>(size, end - offset)) : size;
+
+    OVERLAPPED position{};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD written = 0;
+    if (to_write > 0 && (!WriteFile(download->file, data, static_cast<DWORD>(to_write), &written, &position) ||
+                         written != to_write)) {
+        std::lock_guard<std::mutex> lk(download->mutex);
+        download->error = LB_Error_Unknown;
+        return false;
+    }
+
+    bool reached_end = false;
+    {
+        std::lock_guard<std::mutex> lk(download->mutex);
+        segment->offset += written;
+        reached_end = end != 0 && segment->offset >= end;
+        if (reached_end) {
+            segment->done = true;
+        }
+    }
+    download->received.fetch_add(written);
+    post_download_progress(download);
+    return !reached_end;
+}
+
+// Longest prefix of the part file that holds valid data; segments are kept in file order.
+static uint64_t contiguous_length_locked(lb_net_download *download) {
+    uint64_t length = 0;
+    for (const auto &segment : download->segments) {
+        length = segment->offset;
+        if (!segment->done) {
+            break;
+        }
+    }
+    return length;
+}
+
+// Runs once, after the last segment settled; nothing else touches the segments any more.
+static void finish_download(lb_net_download *download) {
+    bool complete = download->error == LB_Error_Ok && !download->cancelled.load();
+    if (!complete && download->error == LB_Error_Ok) {
+        download->error = LB_Error_Unknown;
+    }
+    uint64_t valid_length = 0;
+    {
+        std::lock_guard<std::mutex> lk(download->mutex);
+        valid_length = contiguous_length_locked(download);
+    }
+    bool resumable = !complete && download->ranges && !download->validator.empty() && valid_length > 0;
+    if (resumable) {
+        truncate_part(download, valid_length);
+    }
+    CloseHandle(download->file);
+    download->file = INVALID_HANDLE_VALUE;
+
+    if (complete) {
+        if (!MoveFileExW(download->part_path.c_str(), download->path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            lbw_log("lb_platform: net_download rename failed (err=%lu)", static_cast<unsigned long>(GetLastError()));
+            download->error = LB_Error_Unknown;
+        }
+        fs_remove_file_impl(download->meta_path_utf8.c_str());
+    } else if (resumable) {
+        std::string meta = std::string(kNetDownloadMetaMagic) + "\n" + download->url + "\n" + download->validator +
+                           "\n" + std::to_string(valid_length) + "\n";
+        fs_write_file_ex_impl(download->meta_path_utf8.c_str(), meta.data(), meta.size(), LB_WriteFlag_Atomic);
+    } else {
+        fs_remove_file_impl(download->part_path_utf8.c_str());
+        fs_remove_file_impl(download->meta_path_utf8.c_str());
+    }
+
+    post_task_impl(&deliver_download_complete, download);
+}
+
+static void segment_complete(void *ctx, LB_ErrorCode error) {
+    auto *segment = static_cast<NetDownloadSegment *>(ctx);
+    lb_net_download *download = segment->download;
+    std::vector<lb_net_request *> to_cancel;
+    bool retry = false;
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lk(download->mutex);
+        segment->transfer = nullptr;
+        segment->in_flight = false;
+        uint64_t total = download->total.load();
+        if (!segment->done && error == LB_Error_Ok &&
+            (segment->end != 0 ? segment->offset >= segment->end : total == 0 || segment->offset >= total)) {
+            segment->done = true;
+        }
+        if (!segment->done) {
+            if (!download->cancelled.load() && download->error == LB_Error_Ok && download->ranges &&
+                segment->attempts <= kNetDownloadMaxRetries) {
+                retry = true;
+            } else {
+                if (download->error == LB_Error_Ok) {
+                    download->error = error != LB_Error_Ok ? error : LB_Error_Unknown;
+                }
+                for (const auto &other : download->segments) {
+                    if (other->transfer) {
+                        lbw_net_retain_transfer(other->transfer);
+                        to_cancel.push_back(other->transfer);
+                    }
+                }
+            }
+        }
+        if (!retry) {
+            finished = --download->live == 0;
+        }
+    }
+
+    // Cancelling a queued transfer settles its segment on this thread, which can finish and free
+    // the download; the references taken above keep the remaining transfers valid.
+    for (lb_net_request *transfer : to_cancel) {
+        lbw_net_cancel_transfer(transfer);
+        lbw_net_release_transfer(transfer);
+    }
+    if (retry) {
+        start_attempt(segment);
+    } else if (finished) {
+        finish_download(download);
+    }
+}
+
+// Starts the segment's next transfer and registers it with the download. On failure nothing
+// was scheduled and the segment is left for the caller to settle.
+static LB_ErrorCode launch_attempt(NetDownloadSegment *segment) {
+    lb_net_download *download = segment->download;
+    // The new transfer can finish, and settle the whole download, on a worker before this
+    // returns; keep the download alive until the transfer is registered.
+    download->refs.fetch_add(1);
+    NetHeaderList headers = download->headers;
+    uint32_t attempt = 0;
+    {
+        std::lock_guard<std::mutex> lk(download->mutex);
+        bool probe = segment->primary && download->max_connections > 1;
+        if (segment->offset > 0 || segment->end != 0 || probe) {
+            std::string range = "bytes=" + std::to_string(segment->offset) + "-";
+            if (segment->end != 0) {
+                range += std::to_string(segment->end - 1);
+            }
+            headers.emplace_back("Range", range);
+            if (!download->validator.empty()) {
+                headers.emplace_back("If-Range", download->validator);
+            }
+        }
+        attempt = ++segment->attempts;
+        segment->in_flight = true;
+    }
+
+    NetTransferSink sink{&segment_response, &segment_data, &segment_complete, segment};
+    lb_net_request *transfer = nullptr;
+    LB_ErrorCode rc = lbw_net_start_transfer(download->url.c_str(), headers, download->priority, sink, &transfer);
+    if (rc != LB_Error_Ok) {
+        {
+            std::lock_guard<std::mutex> lk(download->mutex);
+            segment->in_flight = false;
+        }
+        release_download(download);
+        return rc;
+    }
+
+    {
+        // The attempt may already have finished, or even been retried, on a worker.
+        std::lock_guard<std::mutex> lk(download->mutex);
+        download->transfers.push_back(transfer);
+        if (segment->attempts == attempt && segment->in_flight) {
+            segment->transfer = transfer;
+        }
+    }
+    if (download->cancelled.load()) {
+        lbw_net_cancel_transfer(transfer);
+    }
+    release_download(download);
+    return LB_Error_Ok;
+}
+
+static void start_attempt(NetDownloadSegment *segment) {
+    LB_ErrorCode rc = launch_attempt(segment);
+    if (rc != LB_Error_Ok) {
+        {
+            std::lock_guard<std::mutex> lk(segment->download->mutex);
+            segment->download->error = rc;
+        }
+        segment_complete(segment, rc);
+    }
+}
+
+// Reopens "<path>.part" from a resume record left by an interrupted download of the same URL.
+static bool resume_part(lb_net_download *download, NetDownloadSegment *primary) {
+    LB_FileResult meta{};
+    if (fs_read_entire_file_impl(download->meta_path_utf8.c_str(), &meta) != LB_Error_Ok) {
+        return false;
+    }
+    std::string text(reinterpret_cast<const char *>(meta.buffer.data), meta.buffer.size);
+    CoTaskMemFree(meta.buffer.data);
+
+    std::vector<std::string> lines;
+    for (size_t start = 0, newline; (newline = text.find('\n', start)) != std::string::npos; start = newline + 1) {
+        lines.push_back(text.substr(start, newline - start));
+    }
+    uint64_t valid_length = 0;
+    if (lines.size() != 4 || lines[0] != kNetDownloadMetaMagic || lines[1] != download->url || lines[2].empty() ||
+        !parse_u64(lines[3].c_str(), lines[3].c_str() + lines[3].size(), valid_length)) {
+        return false;
+    }
+
+    download->file = CreateFileW(download->part_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (download->file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(download->file, &size) || static_cast<uint64_t>(size.QuadPart) < valid_length ||
+        !truncate_part(download, valid_length)) {
+        CloseHandle(download->file);
+        download->file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    download->validator = lines[2];
+    download->ranges = true;
+    download->received.store(valid_length);
+    primary->offset = valid_length;
+    return true;
+}
+
+extern "C" LB_ErrorCode net_download_impl(const LB_NetDownloadDesc *desc, const LB_NetDownloadCallbacks *callbacks, void *ctx, lb_net_download **out_handle) {
+    if (out_handle) {
+        *out_handle = nullptr;
+    }
+    if (!desc || !desc->url_utf8 || !desc->path_utf8 || !callbacks || !callbacks->on_complete) {
+        return LB_Error_BadArgument;
+    }
+
+    auto download = std::make_unique<lb_net_download>();
+    download->callbacks = *callbacks;
+    download->callback_ctx = ctx;
+    download->url = desc->url_utf8;
+    for (size_t i = 0; desc->headers && i < desc->header_count; ++i) {
+        download->headers.emplace_back(desc->headers[i].name ? desc->headers[i].name : "",
+                                       desc->headers[i].value ? desc->headers[i].value : "");
+    }
+    download->priority = desc->priority;
+    download->max_connections = std::clamp<uint32_t>(desc->max_connections, 1, kNetDownloadMaxConnections);
+    download->path = lbw_utf8_to_wide(desc->path_utf8);
+    if (download->path.empty()) {
+        return LB_Error_BadArgument;
+    }
+    download->part_path = download->path + L".part";
+    download->part_path_utf8 = std::string(desc->path_utf8) + ".part";
+    download->meta_path_utf8 = download->part_path_utf8 + ".meta";
+
+    auto primary = std::make_unique<NetDownloadSegment>();
+    primary->download = download.get();
+    primary->primary = true;
+    bool resumed = (desc->flags & LB_NetDownloadFlag_Resume) && resume_part(download.get(), primary.get());
+    if (!resumed) {
+        download->file = CreateFileW(download->part_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                     FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (download->file == INVALID_HANDLE_VALUE) {
+            DWORD err = GetLastError();
+            return err == ERROR_PATH_NOT_FOUND ? LB_Error_NotFound : LB_Error_Unknown;
+        }
+        fs_remove_file_impl(download->meta_path_utf8.c_str());
+    }
+
+    NetDownloadSegment *first = primary.get();
+    download->segments.push_back(std::move(primary));
+    download->live = 1;
+    // Once the first attempt is scheduled the download belongs to its completion, which may run
+    // on a worker before this returns.
+    lb_net_download *raw = download.release();
+    LB_ErrorCode rc = launch_attempt(first);
+    if (rc != LB_Error_Ok) {
+        // Nothing was scheduled, so no callback is owed; a resumed part file is left as it was.
+        CloseHandle(raw->file);
+        if (!resumed) {
+            fs_remove_file_impl(raw->part_path_utf8.c_str());
+        }
+        destroy_download(raw);
+        return rc;
+    }
+    if (out_handle) {
+        *out_handle = raw;
+    }
+    return LB_Error_Ok;
+}
+
+// Returns without waiting: every attempt in flight is cancelled like a net request, and the part
+// file is kept for LB_NetDownloadFlag_Resume when the server supports ranges.
+extern "C" void net_download_cancel_impl(lb_net_download *handle) {
+    if (!handle) {
+        return;
+    }
+    std::vector<lb_net_request *> to_cancel;
+    {
+        std::lock_guard<std::mutex> lk(handle->mutex);
+        if (handle->cancelled.exchange(true)) {
+            return;
+        }
+        for (const auto &segment : handle->segments) {
+            if (segment->transfer) {
+                lbw_net_retain_transfer(segment->transfer);
+                to_cancel.push_back(segment->transfer);
+            }
+        }
+    }
+    // The download may be freed by any of these cancels; only the retained transfers are used.
+    for (lb_net_request *transfer : to_cancel) {
+        lbw_net_cancel_transfer(transfer);
+        lbw_net_release_transfer(transfer);
+    }
+}
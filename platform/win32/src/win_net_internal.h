@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lb_platform.h"
+
+// UTF-8 header name/value pairs as sent or received on the wire.
+using NetHeaderList = std::vector<std::pair<std::string, std::string>>;
+
+// Case-insensitive lookup; returns nullptr when the header is absent.
+const std::string *lbw_net_find_header(const NetHeaderList &headers, const char *name);
+
+// Stored response shared between the memory tier, the disk tier and requests serving it.
+// Entries are immutable once published; revalidation publishes a replacement.
+struct NetCacheEntry {
+    std::string url;
+    uint32_t status{};
+    NetHeaderList headers;
+    NetHeaderList vary;          // request header values the response varies on
+    std::shared_ptr<const std::vector<uint8_t>> body;
+    uint64_t response_time{};    // seconds since the Unix epoch when the response arrived
+    uint64_t initial_age{};      // Age reported by the server at that time
+    uint64_t lifetime{};         // freshness lifetime in seconds
+};
+
+enum class NetCacheLookup {
+    Miss,
+    Fresh, // serve without contacting the origin
+    Stale  // revalidate with the entry's validators
+};
+
+// HTTP cache for GET responses (win_net_cache.cpp). Disabled until net_cache_configure.
+bool lbw_net_cache_enabled();
+NetCacheLookup lbw_net_cache_lookup(const std::string &url, const NetHeaderList &request_headers,
+                                    std::shared_ptr<const NetCacheEntry> &out);
+// Adds If-None-Match / If-Modified-Since for a stale entry to `request_headers`.
+void lbw_net_cache_add_validators(const NetCacheEntry &entry, NetHeaderList &request_headers);
+// Stores a response if its headers allow it.
+void lbw_net_cache_store(const std::string &url, const NetHeaderList &request_headers, uint32_t status,
+                         const NetHeaderList &headers, const uint8_t *body, size_t body_size);
+// Merges a 304 response into a stale entry and returns the refreshed entry.
+std::shared_ptr<const NetCacheEntry> lbw_net_cache_revalidated(const std::shared_ptr<const NetCacheEntry> &entry,
+                                                               const NetHeaderList &not_modified_headers);
+// Records a stale entry that the origin replaced with a full response.
+void lbw_net_cache_count_miss();
+
+// Worker-side consumer for internal transfers such as net_download. The callbacks run on the
+// network worker, except that on_complete runs on the cancelling thread when a transfer is
+// cancelled before it was dispatched. on_complete runs exactly once.
+struct NetTransferSink {
+    bool (*on_response)(void *ctx, uint32_t status, const NetHeaderList &headers); // false aborts
+    bool (*on_data)(void *ctx, const uint8_t *data, size_t size);                 // false stops reading
+    void (*on_complete)(void *ctx, LB_ErrorCode error);
+    void *ctx;
+};
+
+// Schedules a GET whose response feeds `sink` instead of a consumer callback. The caller owns a
+// reference to the returned request and drops it with lbw_net_release_transfer; on_complete may
+// already have run by the time this returns. lbw_net_cancel_transfer aborts like net_request_cancel.
+LB_ErrorCode lbw_net_start_transfer(const char *url_utf8, const NetHeaderList &headers, int32_t priority,
+                                    const NetTransferSink &sink, lb_net_request **out);
+void lbw_net_cancel_transfer(lb_net_request *req);
+// Takes an extra reference, dropped again with lbw_net_release_transfer.
+void lbw_net_retain_transfer(lb_net_request *req);
+void lbw_net_release_transfer(lb_net_request *req);
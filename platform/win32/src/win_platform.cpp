@@ -1,6 +1,9 @@
 #include <windows.h>
 #include <objbase.h>
 
+#include <cstddef>
+#include <cstring>
+
 #include "lb_platform.h"
 
 extern "C" {
@@ -25,12 +28,49 @@ LB_ErrorCode fs_write_entire_file_impl(const char *path_utf8, const void *data,
 LB_ErrorCode fs_remove_file_impl(const char *path_utf8);
 LB_ErrorCode fs_stat_impl(const char *path_utf8, LB_FileStat *out);
 LB_ErrorCode fs_list_directory_impl(const char *path_utf8, LB_DirectoryListing *out);
+LB_ErrorCode fs_list_directory_ex_impl(const char *path_utf8, LB_DirectoryListingEx *out);
+LB_ErrorCode fs_dir_open_impl(const char *path_utf8, lb_dir_iterator **out);
+LB_ErrorCode fs_dir_next_batch_impl(lb_dir_iterator *it, LB_DirectoryListingEx *out);
+void fs_dir_close_impl(lb_dir_iterator *it);
+LB_ErrorCode fs_walk_impl(const char *root_utf8, const LB_WalkOptions *options, LB_WalkBatchCallback cb, void *ctx);
+LB_ErrorCode fs_watch_impl(const char *path_utf8, int recursive, LB_FsWatchCallback cb, void *ctx, lb_fs_watch **out_handle);
+void fs_unwatch_impl(lb_fs_watch *handle);
+LB_ErrorCode fs_read_range_impl(const char *path_utf8, uint64_t offset, size_t length, LB_FileResult *out);
+LB_ErrorCode fs_read_stream_impl(const char *path_utf8, uint64_t offset, uint64_t length, size_t chunk_size, LB_FileChunkCallback cb, void *ctx);
+LB_ErrorCode fs_prefetch_impl(const char *const *paths_utf8, size_t count, LB_FsPrefetchCallback cb, void *ctx);
+void fs_cache_configure_impl(uint64_t capacity_bytes);
+LB_ErrorCode fs_cache_read_impl(const char *path_utf8, LB_CachedFile *out);
+void fs_cache_release_impl(LB_CachedFile *file);
+void fs_cache_get_stats_impl(LB_FileCacheStats *out);
+LB_ErrorCode bundle_open_impl(const char *path_utf8, lb_bundle **out);
+LB_ErrorCode bundle_lookup_impl(lb_bundle *bundle, const char *resource_path_utf8, LB_BundleSlice *out);
+void bundle_close_impl(lb_bundle *bundle);
+LB_ErrorCode fs_write_file_ex_impl(const char *path_utf8, const void *data, size_t size, uint32_t flags);
+LB_ErrorCode fs_write_async_ex_impl(const char *path_utf8, const void *data, size_t size, uint32_t flags, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+LB_ErrorCode net_request_stream_impl(const LB_NetRequestDesc *desc, const LB_NetStreamCallbacks *callbacks, void *ctx, lb_net_request **out_handle);
+LB_ErrorCode net_cache_configure_impl(const char *disk_dir_utf8, uint64_t memory_bytes, uint64_t disk_bytes);
+void net_cache_get_stats_impl(LB_NetCacheStats *out);
+void net_request_set_priority_impl(lb_net_request *handle, int32_t priority);
+void net_get_scheduler_stats_impl(LB_NetSchedulerStats *out);
+LB_ErrorCode net_get_origin_timing_impl(const char *url_utf8, LB_NetOriginTiming *out);
+LB_ErrorCode net_dns_prefetch_impl(const char *host_utf8);
+LB_ErrorCode net_preconnect_impl(const char *origin_utf8, uint32_t count, uint32_t flags);
+void net_get_preconnect_stats_impl(LB_NetPreconnectStats *out);
+LB_ErrorCode net_download_impl(const LB_NetDownloadDesc *desc, const LB_NetDownloadCallbacks *callbacks, void *ctx, lb_net_download **out_handle);
+void net_download_cancel_impl(lb_net_download *handle);
+LB_ErrorCode fs_map_file_impl(const char *path_utf8, uint32_t hints, LB_MappedFile *out);
+void fs_unmap_file_impl(LB_MappedFile *file);
+LB_ErrorCode fs_read_async_impl(const char *path_utf8, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+LB_ErrorCode fs_write_async_impl(const char *path_utf8, const void *data, size_t size, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+LB_ErrorCode fs_stat_async_impl(const char *path_utf8, LB_FsAsyncCallback cb, void *ctx, lb_fs_request **out_handle);
+void fs_request_cancel_impl(lb_fs_request *handle);
 void lbw_buffer_free_impl(void *ptr);
 
 LB_ErrorCode clipboard_write_text_impl(const char *utf8, size_t length);
 LB_ErrorCode clipboard_read_text_impl(LB_Buffer *out);
 
 LB_ErrorCode net_request_impl(const LB_NetRequestDesc *desc, LB_NetResponseCallback cb, void *ctx, lb_net_request **out_handle);
+LB_ErrorCode net_request_v1_impl(const LB_NetRequestDesc *desc, LB_NetResponseCallback cb, void *ctx, lb_net_request **out_handle);
 void net_request_cancel_impl(lb_net_request *handle);
 }
 
@@ -65,12 +105,7 @@ static LB_ErrorCode platform_init() {
     return LB_Error_Ok;
 }
 
-extern "C" __declspec(dllexport)
-LB_ErrorCode LB_QueryPlatformV1(LB_PlatformV1 *out) {
-    if (!out) {
-        return LB_Error_BadArgument;
-    }
-
+static void fill_platform_table() {
     g_v1.abi_version = LB_PLATFORM_ABI_VERSION;
     g_v1.init = platform_init;
     g_v1.shutdown = []() {
@@ -93,13 +128,78 @@ LB_ErrorCode LB_QueryPlatformV1(LB_PlatformV1 *out) {
     g_v1.fs_remove_file = fs_remove_file_impl;
     g_v1.fs_stat = fs_stat_impl;
     g_v1.fs_list_directory = fs_list_directory_impl;
+    g_v1.fs_map_file = fs_map_file_impl;
+    g_v1.fs_unmap_file = fs_unmap_file_impl;
+    g_v1.fs_read_async = fs_read_async_impl;
+    g_v1.fs_write_async = fs_write_async_impl;
+    g_v1.fs_stat_async = fs_stat_async_impl;
+    g_v1.fs_request_cancel = fs_request_cancel_impl;
+    g_v1.fs_list_directory_ex = fs_list_directory_ex_impl;
+    g_v1.fs_dir_open = fs_dir_open_impl;
+    g_v1.fs_dir_next_batch = fs_dir_next_batch_impl;
+    g_v1.fs_dir_close = fs_dir_close_impl;
+    g_v1.fs_walk = fs_walk_impl;
+    g_v1.fs_watch = fs_watch_impl;
+    g_v1.fs_unwatch = fs_unwatch_impl;
+    g_v1.fs_read_range = fs_read_range_impl;
+    g_v1.fs_read_stream = fs_read_stream_impl;
+    g_v1.fs_prefetch = fs_prefetch_impl;
+    g_v1.fs_cache_configure = fs_cache_configure_impl;
+    g_v1.fs_cache_read = fs_cache_read_impl;
+    g_v1.fs_cache_release = fs_cache_release_impl;
+    g_v1.fs_cache_get_stats = fs_cache_get_stats_impl;
+    g_v1.bundle_open = bundle_open_impl;
+    g_v1.bundle_lookup = bundle_lookup_impl;
+    g_v1.bundle_close = bundle_close_impl;
+    g_v1.fs_write_file_ex = fs_write_file_ex_impl;
+    g_v1.fs_write_async_ex = fs_write_async_ex_impl;
+    g_v1.net_request_stream = net_request_stream_impl;
+    g_v1.net_cache_configure = net_cache_configure_impl;
+    g_v1.net_cache_get_stats = net_cache_get_stats_impl;
+    g_v1.net_request_set_priority = net_request_set_priority_impl;
+    g_v1.net_get_scheduler_stats = net_get_scheduler_stats_impl;
+    g_v1.net_get_origin_timing = net_get_origin_timing_impl;
+    g_v1.net_dns_prefetch = net_dns_prefetch_impl;
+    g_v1.net_preconnect = net_preconnect_impl;
+    g_v1.net_get_preconnect_stats = net_get_preconnect_stats_impl;
+    g_v1.net_download = net_download_impl;
+    g_v1.net_download_cancel = net_download_cancel_impl;
     g_v1.buffer_free = lbw_buffer_free_impl;
     g_v1.clipboard_write_text = clipboard_write_text_impl;
     g_v1.clipboard_read_text = clipboard_read_text_impl;
     g_v1.net_request = net_request_impl;
     g_v1.net_request_cancel = net_request_cancel_impl;
+}
+
+// Version 1 of the table ends at net_request_cancel; later entries were appended after it.
+static const size_t kPlatformV1Size = offsetof(LB_PlatformV1, net_request_cancel) + sizeof(g_v1.net_request_cancel);
+
+extern "C" __declspec(dllexport)
+LB_ErrorCode LB_QueryPlatform(LB_PlatformV1 *out, size_t out_size) {
+    if (!out || out_size < kPlatformV1Size) {
+        return LB_Error_BadArgument;
+    }
 
-    *out = g_v1;
+    fill_platform_table();
+    memset(out, 0, out_size);
+    memcpy(out, &g_v1, out_size < sizeof(g_v1) ? out_size : sizeof(g_v1));
     lbw_log("lb_platform: ABI v%u exported", g_v1.abi_version);
     return LB_Error_Ok;
 }
+
+// Entry point for hosts built against ABI version 1: their table stops at net_request_cancel
+// and their LB_NetRequestDesc lacks the fields added since.
+extern "C" __declspec(dllexport)
+LB_ErrorCode LB_QueryPlatformV1(LB_PlatformV1 *out) {
+    if (!out) {
+        return LB_Error_BadArgument;
+    }
+
+    fill_platform_table();
+    LB_PlatformV1 v1 = g_v1;
+    v1.abi_version = 1u;
+    v1.net_request = net_request_v1_impl;
+    memcpy(out, &v1, kPlatformV1Size);
+    lbw_log("lb_platform: ABI v%u exported", v1.abi_version);
+    return LB_Error_Ok;
+}
@@ -0,0 +1,227 @@
+#include "win_utf.h"
+
+#include <cstring>
+#include <cwchar>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LBW_UTF_SSE2 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define LBW_UTF_NEON 1
+#endif
+
+static_assert(sizeof(wchar_t) == 2, "UTF-16 wchar_t expected");
+
+static const wchar_t kReplacementChar = 0xFFFD;
+
+// Widens the leading ASCII run of `s` into `out`, returning its length.
+static size_t widen_ascii(const unsigned char *s, size_t length, wchar_t *out) {
+    size_t i = 0;
+#if defined(LBW_UTF_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        if (_mm_movemask_epi8(v) != 0) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+#elif defined(LBW_UTF_NEON)
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t v = vld1q_u8(s + i);
+        if (vmaxvq_u8(v) >= 0x80) {
+            break;
+        }
+        vst1q_u16(reinterpret_cast<uint16_t *>(out + i), vmovl_u8(vget_low_u8(v)));
+        vst1q_u16(reinterpret_cast<uint16_t *>(out + i + 8), vmovl_high_u8(v));
+    }
+#endif
+    while (i < length && s[i] < 0x80) {
+        out[i] = static_cast<wchar_t>(s[i]);
+        ++i;
+    }
+    return i;
+}
+
+// Narrows the leading ASCII run of `s` into `out`, returning its length.
+static size_t narrow_ascii(const wchar_t *s, size_t length, char *out) {
+    size_t i = 0;
+#if defined(LBW_UTF_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    for (; i + 8 <= length; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, non_ascii), zero)) != 0xFFFF) {
+            break;
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(v, v));
+    }
+#elif defined(LBW_UTF_NEON)
+    for (; i + 8 <= length; i += 8) {
+        uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t *>(s + i));
+        if (vmaxvq_u16(v) >= 0x80) {
+            break;
+        }
+        vst1_u8(reinterpret_cast<uint8_t *>(out + i), vmovn_u16(v));
+    }
+#endif
+    while (i < length && static_cast<uint16_t>(s[i]) < 0x80) {
+        out[i] = static_cast<char>(s[i]);
+        ++i;
+    }
+    return i;
+}
+
+size_t lbw_utf8_to_wide_into(const char *src, size_t length, wchar_t *out, size_t capacity) {
+    if (!out || capacity < lbw_utf8_to_wide_max(length) + 1) {
+        return SIZE_MAX;
+    }
+    if (!src) {
+        length = 0;
+    }
+
+    const auto *s = reinterpret_cast<const unsigned char *>(src);
+    size_t i = 0;
+    size_t o = 0;
+    while (i < length) {
+        size_t run = widen_ascii(s + i, length - i, out + o);
+        i += run;
+        o += run;
+        if (i >= length) {
+            break;
+        }
+
+        uint32_t c = s[i];
+        uint32_t cp = 0;
+        uint32_t min = 0;
+        size_t need = 0;
+        if ((c & 0xE0) == 0xC0) {
+            cp = c & 0x1F;
+            need = 1;
+            min = 0x80;
+        } else if ((c & 0xF0) == 0xE0) {
+            cp = c & 0x0F;
+            need = 2;
+            min = 0x800;
+        } else if ((c & 0xF8) == 0xF0) {
+            cp = c & 0x07;
+            need = 3;
+            min = 0x10000;
+        } else {
+            // Stray continuation byte or invalid lead byte.
+            out[o++] = kReplacementChar;
+            ++i;
+            continue;
+        }
+
+        size_t consumed = 1;
+        while (consumed <= need && i + consumed < length && (s[i + consumed] & 0xC0) == 0x80) {
+            cp = (cp << 6) | (s[i + consumed] & 0x3F);
+            ++consumed;
+        }
+        i += consumed;
+
+        // Truncated, overlong, surrogate or out-of-range sequences collapse to one U+FFFD.
+        if (consumed <= need || cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            out[o++] = kReplacementChar;
+        } else if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out[o++] = static_cast<wchar_t>(0xD800 + (cp >> 10));
+            out[o++] = static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+        } else {
+            out[o++] = static_cast<wchar_t>(cp);
+        }
+    }
+    out[o] = L'\0';
+    return o;
+}
+
+size_t lbw_wide_to_utf8_into(const wchar_t *s, size_t length, char *out, size_t capacity) {
+    if (!out || capacity < lbw_wide_to_utf8_max(length) + 1) {
+        return SIZE_MAX;
+    }
+    if (!s) {
+        length = 0;
+    }
+
+    size_t i = 0;
+    size_t o = 0;
+    while (i < length) {
+        size_t run = narrow_ascii(s + i, length - i, out + o);
+        i += run;
+        o += run;
+        if (i >= length) {
+            break;
+        }
+
+        uint32_t c = static_cast<uint16_t>(s[i++]);
+        if (c < 0x800) {
+            out[o++] = static_cast<char>(0xC0 | (c >> 6));
+            out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+            continue;
+        }
+        if (c >= 0xD800 && c <= 0xDBFF && i < length) {
+            uint32_t low = static_cast<uint16_t>(s[i]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                ++i;
+                uint32_t cp = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                out[o++] = static_cast<char>(0xF0 | (cp >> 18));
+                out[o++] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                out[o++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out[o++] = static_cast<char>(0x80 | (cp & 0x3F));
+                continue;
+            }
+        }
+        if (c >= 0xD800 && c <= 0xDFFF) {
+            // Unpaired surrogate.
+            c = kReplacementChar;
+        }
+        out[o++] = static_cast<char>(0xE0 | (c >> 12));
+        out[o++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+    }
+    out[o] = '\0';
+    return o;
+}
+
+std::wstring lbw_utf8_to_wide(const char *s) {
+    return s ? lbw_utf8_to_wide(s, strlen(s)) : std::wstring();
+}
+
+std::wstring lbw_utf8_to_wide(const char *s, size_t length) {
+    if (!s || length == 0) {
+        return {};
+    }
+    std::wstring out(lbw_utf8_to_wide_max(length), L'\0');
+    // std::wstring owns the terminator slot past size(), so size() + 1 units are writable.
+    out.resize(lbw_utf8_to_wide_into(s, length, out.data(), out.size() + 1));
+    return out;
+}
+
+std::string lbw_wide_to_utf8(const wchar_t *s) {
+    return s ? lbw_wide_to_utf8(s, wcslen(s)) : std::string();
+}
+
+std::string lbw_wide_to_utf8(const wchar_t *s, size_t length) {
+    if (!s || length == 0) {
+        return {};
+    }
+    std::string out(lbw_wide_to_utf8_max(length), '\0');
+    out.resize(lbw_wide_to_utf8_into(s, length, out.data(), out.size() + 1));
+    return out;
+}
+
+WideStackString::WideStackString(const char *s)
+    : WideStackString(s, s ? strlen(s) : 0) {
+}
+
+WideStackString::WideStackString(const char *s, size_t utf8_length) {
+    size_t capacity = lbw_utf8_to_wide_max(utf8_length) + 1;
+    if (capacity > kInlineCapacity) {
+        heap_buffer.reset(new wchar_t[capacity]);
+        data = heap_buffer.get();
+    }
+    length = lbw_utf8_to_wide_into(s, utf8_length, data, capacity);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Shared UTF-8 <-> UTF-16 transcoding for the platform layer.
+//
+// Conversions run in a single pass: the output is sized for the worst case up front
+// (one UTF-16 unit per UTF-8 byte, three UTF-8 bytes per UTF-16 unit) and trimmed afterwards,
+// with a SIMD fast path for ASCII runs. Malformed input is replaced with U+FFFD, like
+// MultiByteToWideChar/WideCharToMultiByte without flags.
+
+constexpr size_t lbw_utf8_to_wide_max(size_t utf8_length) { return utf8_length; }
+constexpr size_t lbw_wide_to_utf8_max(size_t wide_length) { return wide_length * 3; }
+
+// Convert into a caller-provided buffer and null-terminate it. `capacity` must be at least the
+// worst case above plus one; otherwise nothing is written and SIZE_MAX is returned. Returns
+// the number of units written, excluding the terminator.
+size_t lbw_utf8_to_wide_into(const char *s, size_t length, wchar_t *out, size_t capacity);
+size_t lbw_wide_to_utf8_into(const wchar_t *s, size_t length, char *out, size_t capacity);
+
+// Allocating variants; the single-argument forms take null-terminated input. nullptr yields
+// an empty string.
+std::wstring lbw_utf8_to_wide(const char *s);
+std::wstring lbw_utf8_to_wide(const char *s, size_t length);
+std::string lbw_wide_to_utf8(const wchar_t *s);
+std::string lbw_wide_to_utf8(const wchar_t *s, size_t length);
+
+// Null-terminated UTF-16 copy of a UTF-8 string for short-lived use (paths, verbs, header
+// names). Strings up to MAX_PATH units stay on the stack; longer ones spill to the heap.
+class WideStackString {
+public:
+    explicit WideStackString(const char *s);
+    WideStackString(const char *s, size_t length);
+    WideStackString(const WideStackString &) = delete;
+    WideStackString &operator=(const WideStackString &) = delete;
+
+    const wchar_t *c_str() const { return data; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+private:
+    static constexpr size_t kInlineCapacity = 260;
+
+    wchar_t inline_buffer[kInlineCapacity];
+    std::unique_ptr<wchar_t[]> heap_buffer;
+    wchar_t *data{inline_buffer};
+    size_t length{};
+};
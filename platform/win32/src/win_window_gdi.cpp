@@ -10,39 +10,12 @@
 
 #include "lb_platform.h"
 #include "win_window_internal.h"
+#include "win_utf.h"
 
 extern "C" void lbw_set_task_hwnd(HWND hwnd);
 extern "C" void lbw_clear_task_hwnd(HWND hwnd);
 extern "C" void lbw_pump_posted_tasks();
 
-// --- simple UTF-8 -> UTF-16 helper ---
-static std::wstring utf8_to_wide(const char *s) {
-    if (!s) return {};
-    int lenW = MultiByteToWideChar(CP_UTF8, 0, s, -1, nullptr, 0);
-    std::wstring w(lenW > 0 ? lenW : 0, L'\0');
-    if (lenW > 0) {
-        int written = MultiByteToWideChar(CP_UTF8, 0, s, -1, w.data(), lenW);
-        if (written > 0) {
-            w.resize(written - 1); // drop the terminating null
-        } else {
-            w.clear();
-        }
-    }
-    return w;
-}
-
-static std::string wide_to_utf8(const wchar_t *s, int length = -1) {
-    if (!s) return {};
-    int lenU8 = WideCharToMultiByte(CP_UTF8, 0, s, length, nullptr, 0, nullptr, nullptr);
-    if (lenU8 <= 0) return {};
-    std::string out(static_cast<size_t>(lenU8), '\0');
-    WideCharToMultiByte(CP_UTF8, 0, s, length, out.data(), lenU8, nullptr, nullptr);
-    if (length == -1 && !out.empty() && out.back() == '\0') {
-        out.pop_back();
-    }
-    return out;
-}
-
 static UINT get_dpi_for_window_safe(HWND h) {
     HMODULE user32 = GetModuleHandleW(L"user32.dll");
     if (user32) {
@@ -366,7 +339,7 @@ static ATOM ensure_class(HINSTANCE hInst) {
                         if (bytes > 0) {
                             std::wstring wcomp(static_cast<size_t>(bytes / sizeof(wchar_t)), L'\0');
                             ImmGetCompositionStringW(himc, GCS_COMPSTR, wcomp.data(), bytes);
-                            composition = wide_to_utf8(wcomp.c_str(), static_cast<int>(wcomp.size()));
+                            composition = lbw_wide_to_utf8(wcomp.c_str(), wcomp.size());
                         }
                         LONG cpos = ImmGetCompositionStringW(himc, GCS_CURSORPOS, nullptr, 0);
                         if (cpos > 0) {
@@ -405,7 +378,7 @@ static ATOM ensure_class(HINSTANCE hInst) {
                         UINT len = DragQueryFileW(drop, i, nullptr, 0);
                         std::wstring wpath(len + 1, L'\0');
                         DragQueryFileW(drop, i, wpath.data(), len + 1);
-                        std::string u8 = wide_to_utf8(wpath.c_str());
+                        std::string u8 = lbw_wide_to_utf8(wpath.c_str());
                         utf8_paths.push_back(u8);
                         total_bytes += u8.size() + 1;
                     }
@@ -509,7 +482,7 @@ extern "C" lb_window *win_create_impl(int w, int h, const char *title_utf8) {
     win->bmi.bmiHeader.biWidth = 0;
     win->bmi.bmiHeader.biHeight = 0;
 
-    std::wstring wtitle = utf8_to_wide(title_utf8);
+    std::wstring wtitle = lbw_utf8_to_wide(title_utf8);
     HWND hwnd = CreateWindowExW(
         0, L"LadybirdWinPlatform",
         wtitle.empty() ? L"Ladybird Windows — PoC" : wtitle.c_str(),
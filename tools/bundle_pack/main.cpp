@@ -0,0 +1,276 @@
+// Packs a directory tree into a resource bundle readable by the platform's bundle_* API.
+//
+// Usage: lbw_bundle_pack <input_dir> <output_file>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "lb_bundle_format.h"
+
+namespace fs = std::filesystem;
+
+struct InputFile {
+    std::string name; // '/' separated, relative to the input directory
+    fs::path path;
+    uint64_t size{};
+};
+
+// Average keys per bucket; lower values build faster at the cost of a larger seed table.
+static const uint32_t kKeysPerBucket = 4;
+static const uint32_t kMaxSeed = 1u << 24;
+
+static uint32_t bucket_of(const std::string &name, uint32_t bucket_count) {
+    return static_cast<uint32_t>(lb_bundle_hash(name.data(), name.size(), 0) % bucket_count);
+}
+
+static uint32_t slot_of(const std::string &name, uint32_t seed, uint32_t entry_count) {
+    return static_cast<uint32_t>(lb_bundle_hash(name.data(), name.size(), seed) % entry_count);
+}
+
+// Hash-and-displace: place the largest buckets first, searching for a seed that drops every
+// key of the bucket into a distinct free slot.
+static bool build_perfect_hash(const std::vector<InputFile> &files, uint32_t bucket_count,
+                               std::vector<uint32_t> &seeds, std::vector<uint32_t> &slots) {
+    uint32_t n = static_cast<uint32_t>(files.size());
+    std::vector<std::vector<uint32_t>> buckets(bucket_count);
+    for (uint32_t i = 0; i < n; ++i) {
+        buckets[bucket_of(files[i].name, bucket_count)].push_back(i);
+    }
+    std::vector<uint32_t> order(bucket_count);
+    for (uint32_t b = 0; b < bucket_count; ++b) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    seeds.assign(bucket_count, 0);
+    slots.assign(n, 0);
+    std::vector<bool> taken(n, false);
+    std::vector<uint32_t> candidate;
+    for (uint32_t b : order) {
+        const auto &keys = buckets[b];
+        if (keys.empty()) {
+            break;
+        }
+        bool placed = false;
+        for (uint32_t seed = 1; seed < kMaxSeed && !placed; ++seed) {
+            candidate.clear();
+            placed = true;
+            for (uint32_t key : keys) {
+                uint32_t slot = slot_of(files[key].name, seed, n);
+                if (taken[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                    placed = false;
+                    break;
+                }
+                candidate.push_back(slot);
+            }
+            if (placed) {
+                seeds[b] = seed;
+                for (size_t k = 0; k < keys.size(); ++k) {
+                    taken[candidate[k]] = true;
+                    slots[keys[k]] = candidate[k];
+                }
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t align_to(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static uint64_t align_up(uint64_t value) {
+    return align_to(value, LB_BUNDLE_DATA_ALIGNMENT);
+}
+
+static bool write_padding(std::ofstream &out, uint64_t from, uint64_t to) {
+    static const char zeros[LB_BUNDLE_DATA_ALIGNMENT] = {};
+    out.write(zeros, static_cast<std::streamsize>(to - from));
+    return static_cast<bool>(out);
+}
+
+static bool range_fits(uint64_t offset, uint64_t length, uint64_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+// Reads the written bundle back and applies the checks bundle_open and bundle_lookup make, so a
+// layout the runtime would reject fails here instead of at startup.
+static bool verify_bundle(const fs::path &output, const std::vector<InputFile> &files) {
+    std::error_code ec;
+    uint64_t size = fs::file_size(output, ec);
+    std::ifstream in(output, std::ios::binary);
+    if (ec || !in) {
+        return false;
+    }
+    LB_BundleHeader header{};
+    if (size < sizeof(header) || !in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        return false;
+    }
+    if (header.magic != LB_BUNDLE_MAGIC || header.version != LB_BUNDLE_VERSION || header.bucket_count == 0 ||
+        header.file_size > size || header.entry_count != files.size() ||
+        !range_fits(header.seeds_offset, sizeof(uint32_t) * static_cast<uint64_t>(header.bucket_count), size) ||
+        !range_fits(header.entries_offset, sizeof(LB_BundleEntry) * static_cast<uint64_t>(header.entry_count), size) ||
+        header.names_offset > size || header.seeds_offset % alignof(uint32_t) != 0 ||
+        header.entries_offset % alignof(LB_BundleEntry) != 0) {
+        return false;
+    }
+
+    std::vector<char> tables(static_cast<size_t>(header.names_offset));
+    in.seekg(0);
+    if (!in.read(tables.data(), static_cast<std::streamsize>(tables.size()))) {
+        return false;
+    }
+    const auto *seeds = reinterpret_cast<const uint32_t *>(tables.data() + header.seeds_offset);
+    const auto *entries = reinterpret_cast<const LB_BundleEntry *>(tables.data() + header.entries_offset);
+    std::string name;
+    for (const auto &file : files) {
+        uint32_t bucket = bucket_of(file.name, header.bucket_count);
+        const LB_BundleEntry &entry = entries[slot_of(file.name, seeds[bucket], header.entry_count)];
+        name.resize(entry.name_length);
+        in.seekg(static_cast<std::streamoff>(header.names_offset + entry.name_offset));
+        if (entry.name_length != file.name.size() ||
+            !range_fits(header.names_offset + entry.name_offset, entry.name_length, size) ||
+            !in.read(name.data(), static_cast<std::streamsize>(name.size())) || name != file.name ||
+            entry.data_size != file.size || !range_fits(entry.data_offset, entry.data_size, size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <input_dir> <output_file>\n", argv[0]);
+        return 2;
+    }
+    fs::path root = argv[1];
+    fs::path output = argv[2];
+
+    std::error_code ec;
+    std::vector<InputFile> files;
+    for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        InputFile file;
+        file.path = it->path();
+        std::u8string name = fs::relative(it->path(), root, ec).generic_u8string();
+        file.name.assign(reinterpret_cast<const char *>(name.data()), name.size());
+        file.size = it->file_size(ec);
+        if (ec) {
+            break;
+        }
+        files.push_back(std::move(file));
+    }
+    if (ec) {
+        std::fprintf(stderr, "lbw_bundle_pack: failed to scan %s: %s\n", root.string().c_str(), ec.message().c_str());
+        return 1;
+    }
+    if (files.size() > UINT32_MAX) {
+        std::fprintf(stderr, "lbw_bundle_pack: too many files\n");
+        return 1;
+    }
+    // Deterministic output for identical inputs.
+    std::sort(files.begin(), files.end(), [](const InputFile &a, const InputFile &b) { return a.name < b.name; });
+
+    uint32_t entry_count = static_cast<uint32_t>(files.size());
+    uint32_t bucket_count = std::max<uint32_t>(1, (entry_count + kKeysPerBucket - 1) / kKeysPerBucket);
+    std::vector<uint32_t> seeds;
+    std::vector<uint32_t> slots;
+    while (!build_perfect_hash(files, bucket_count, seeds, slots)) {
+        bucket_count *= 2;
+    }
+
+    LB_BundleHeader header{};
+    header.magic = LB_BUNDLE_MAGIC;
+    header.version = LB_BUNDLE_VERSION;
+    header.entry_count = entry_count;
+    header.bucket_count = bucket_count;
+    header.seeds_offset = sizeof(LB_BundleHeader);
+    header.entries_offset = align_to(header.seeds_offset + sizeof(uint32_t) * static_cast<uint64_t>(bucket_count),
+                                     LB_BUNDLE_TABLE_ALIGNMENT);
+    header.names_offset = header.entries_offset + sizeof(LB_BundleEntry) * static_cast<uint64_t>(entry_count);
+
+    std::vector<LB_BundleEntry> entries(entry_count);
+    std::string names;
+    uint64_t names_size = 0;
+    for (const auto &file : files) {
+        names_size += file.name.size();
+    }
+    if (names_size > UINT32_MAX) {
+        std::fprintf(stderr, "lbw_bundle_pack: name block too large\n");
+        return 1;
+    }
+    uint64_t data_cursor = align_up(header.names_offset + names_size);
+    for (uint32_t i = 0; i < entry_count; ++i) {
+        LB_BundleEntry &entry = entries[slots[i]];
+        entry.name_offset = static_cast<uint32_t>(names.size());
+        entry.name_length = static_cast<uint32_t>(files[i].name.size());
+        entry.data_offset = data_cursor;
+        entry.data_size = files[i].size;
+        names += files[i].name;
+        data_cursor = align_up(data_cursor + files[i].size);
+    }
+    header.file_size = data_cursor;
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::fprintf(stderr, "lbw_bundle_pack: cannot open %s\n", output.string().c_str());
+        return 1;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(seeds.data()), static_cast<std::streamsize>(seeds.size() * sizeof(uint32_t)));
+    write_padding(out, header.seeds_offset + seeds.size() * sizeof(uint32_t), header.entries_offset);
+    out.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(LB_BundleEntry)));
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+    uint64_t position = header.names_offset + names.size();
+    write_padding(out, position, align_up(position));
+    position = align_up(position);
+
+    std::vector<char> chunk(1 << 20);
+    for (uint32_t i = 0; i < entry_count; ++i) {
+        std::ifstream in(files[i].path, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "lbw_bundle_pack: cannot read %s\n", files[i].path.string().c_str());
+            return 1;
+        }
+        uint64_t remaining = files[i].size;
+        while (remaining > 0) {
+            std::streamsize want = static_cast<std::streamsize>(std::min<uint64_t>(remaining, chunk.size()));
+            in.read(chunk.data(), want);
+            if (in.gcount() != want) {
+                std::fprintf(stderr, "lbw_bundle_pack: %s changed while packing\n", files[i].path.string().c_str());
+                return 1;
+            }
+            out.write(chunk.data(), want);
+            remaining -= static_cast<uint64_t>(want);
+        }
+        position += files[i].size;
+        write_padding(out, position, align_up(position));
+        position = align_up(position);
+    }
+
+    if (!out.flush()) {
+        std::fprintf(stderr, "lbw_bundle_pack: write to %s failed\n", output.string().c_str());
+        return 1;
+    }
+    out.close();
+    if (!verify_bundle(output, files)) {
+        std::fprintf(stderr, "lbw_bundle_pack: %s failed verification\n", output.string().c_str());
+        return 1;
+    }
+    std::printf("lbw_bundle_pack: %u files, %llu bytes -> %s\n", entry_count,
+                static_cast<unsigned long long>(header.file_size), output.string().c_str());
+    return 0;
+}